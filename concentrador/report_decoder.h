@@ -0,0 +1,219 @@
+/**
+    Header que contiene el decodificador de reportes binarios del lado del concentrador.
+    Mantiene, por cada nodo, los últimos REPORT_REFERENCE_HISTORY reportes decodificados,
+    que son las únicas referencias válidas para los reportes diferenciales (ver report_helpers.h).
+    Los reportes empaquetados se decodifican con la misma PackedReportSchema que el nodo
+    (ver report_fields.h): si los nodos deshabilitan campos, incluir antes su constants.h.
+    Las series de corriente (reportType() == REPORT_TYPE_SERIES) no llevan referencia y se
+    decodifican directamente con decodeSeriesReport() (ver report_series.h), y los lotes
+    (REPORT_TYPE_BATCH) se recorren con nextBatchRecord(), decodificando cada registro en orden.
+    Los reportes confirmados (REPORT_TYPE_CONFIRMED) se desenvuelven y, por cada nodo, se recuerdan
+    sus últimos REPORT_CONFIRMED_HISTORY seq para descartar las retransmisiones.
+    Para los nodos con LORA_IMPLICIT_REPORT, el concentrador escucha con LORA_IMPLICIT_SYNC_WORD y
+    LoRa.receive(IMPLICIT_REPORT_SIZE) (header implícito), y les responde con header explícito.
+    @file report_decoder.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef REPORT_DECODER_H
+#define REPORT_DECODER_H
+
+#include <math.h>
+#include <string>
+#include <unordered_map>
+
+#include "../nodo-sisicic/report_helpers.h"
+#include "../nodo-sisicic/report_fields.h"
+
+/**
+    DecodeStatus indica el resultado de ReportDecoder::decode().
+*/
+enum DecodeStatus {
+    DECODE_OK,                  // Reporte decodificado (y guardado como posible referencia).
+    DECODE_MALFORMED,           // Reporte truncado, de una versión desconocida o de otra PackedReportSchema.
+    DECODE_MISSING_REFERENCE,   // Reporte diferencial cuya referencia ya no se recuerda.
+    DECODE_DUPLICATE            // Retransmisión de un reporte confirmado ya decodificado (debe confirmarse igual).
+};
+
+/**
+    ReportDecoder decodifica reportes completos y diferenciales de múltiples nodos.
+    Por ejemplo:
+        ReportDecoder decoder;
+        Report report;
+        DecodeStatus status = decoder.decode(packet, packetLength, report);
+        if (reportType(packet) == REPORT_TYPE_CONFIRMED) {
+            if (status == DECODE_OK || status == DECODE_DUPLICATE) {
+                sendDownlink(ReportDecoder::confirmCommand(packet, LoRa.packetSnr()));  // "<20009>cnf1234,7"
+            }
+        } else if (status == DECODE_OK) {
+            sendDownlink(ReportDecoder::ackCommand(report, LoRa.packetSnr()));      // "<20009>ack17,7"
+        }
+*/
+class ReportDecoder {
+public:
+    /**
+        decode() decodifica un reporte binario y lo recuerda como posible referencia
+        de los siguientes reportes diferenciales del mismo nodo.
+        @param buf Paquete recibido.
+        @param len Cantidad de bytes del paquete.
+        @param &report Reporte decodificado.
+        @return Resultado de la decodificación.
+    */
+    DecodeStatus decode(const uint8_t buf[], size_t len, Report& report) {
+        if (len < 3) {
+            return DECODE_MALFORMED;
+        }
+        if (buf[0] == reportHeader(REPORT_TYPE_FULL)) {
+            if (!decodeReport(buf, len, report)) {
+                return DECODE_MALFORMED;
+            }
+        } else if (buf[0] == reportHeader(REPORT_TYPE_PACKED)) {
+            report = Report();
+            report.raindrops = -1;
+            report.lat = REPORT_UNKNOWN_COORD;
+            report.lng = REPORT_UNKNOWN_COORD;
+            report.alt = REPORT_UNKNOWN_ALT;
+            if (!decodePackedReport(buf, len, report)) {
+                return DECODE_MALFORMED;
+            }
+        } else if (buf[0] == reportHeader(REPORT_TYPE_DELTA)) {
+            if (len < REPORT_DELTA_HEADER_SIZE) {
+                return DECODE_MALFORMED;
+            }
+            const Report* reference = find(getU16(buf, 1), buf[4]);
+            if (reference == NULL) {
+                return DECODE_MISSING_REFERENCE;
+            }
+            if (!decodeDeltaReport(buf, len, *reference, report)) {
+                return DECODE_MALFORMED;
+            }
+        } else if (buf[0] == reportHeader(REPORT_TYPE_CONFIRMED)) {
+            uint16_t deviceId;
+            uint16_t seq;
+            const uint8_t* record;
+            size_t recordLength;
+            if (!decodeConfirmedReport(buf, len, deviceId, seq, record, recordLength)
+                    || record[0] == reportHeader(REPORT_TYPE_CONFIRMED)) {
+                return DECODE_MALFORMED;
+            }
+            if (isDuplicate(deviceId, seq)) {
+                return DECODE_DUPLICATE;
+            }
+            DecodeStatus status = decode(record, recordLength, report);
+            if (status == DECODE_OK) {
+                rememberConfirmed(deviceId, seq);
+            }
+            return status;
+        } else {
+            return DECODE_MALFORMED;
+        }
+        remember(report);
+        return DECODE_OK;
+    }
+
+    /**
+        forget() olvida todas las referencias de un nodo (por ejemplo, si se reinició).
+        @param deviceId Identificador del nodo.
+    */
+    void forget(uint16_t deviceId) {
+        nodes.erase(deviceId);
+        confirmed.erase(deviceId);
+    }
+
+    /**
+        ackCommand() compone el comando de reconocimiento de un reporte, con el mismo
+        formato que el resto de los comandos LoRa ("<" + ID + ">" + comando), incluyendo
+        la SNR con que se recibió el reporte para el ADR del nodo (ver adr_helpers.h).
+        @param report Reporte a reconocer.
+        @param snr SNR con que se recibió el reporte (en dB).
+        @return Comando a transmitir al nodo.
+    */
+    static std::string ackCommand(const Report& report, float snr) {
+        return "<" + std::to_string(report.deviceId) + ">ack" + std::to_string(report.seq) + snrSuffix(snr);
+    }
+
+    /**
+        confirmCommand() compone el comando de confirmación de un reporte confirmado.
+        @param buf Reporte confirmado recibido (de al menos REPORT_CONFIRMED_HEADER_SIZE bytes).
+        @param snr SNR con que se recibió el reporte (en dB).
+        @return Comando a transmitir al nodo.
+    */
+    static std::string confirmCommand(const uint8_t buf[], float snr) {
+        return "<" + std::to_string(getU16(buf, 1)) + ">cnf" + std::to_string(getU16(buf, 3)) + snrSuffix(snr);
+    }
+
+private:
+    /**
+        NodeHistory guarda los últimos reportes de un nodo, indexados por seq % REPORT_REFERENCE_HISTORY.
+    */
+    struct NodeHistory {
+        Report reports[REPORT_REFERENCE_HISTORY];
+        bool valid[REPORT_REFERENCE_HISTORY] = {false};
+    };
+
+    /**
+        ConfirmedHistory guarda los últimos seq confirmados de un nodo, en orden circular.
+    */
+    struct ConfirmedHistory {
+        uint16_t seqs[REPORT_CONFIRMED_HISTORY];
+        uint8_t count = 0;
+        uint8_t next = 0;
+    };
+
+    std::unordered_map<uint16_t, NodeHistory> nodes;
+
+    /**
+        snrSuffix() compone el sufijo ",<snr>" de "ack" y "cnf", redondeando la SNR a dB enteros.
+        @param snr SNR (en dB).
+        @return Sufijo del comando.
+    */
+    static std::string snrSuffix(float snr) {
+        return "," + std::to_string(lround(snr));
+    }
+    std::unordered_map<uint16_t, ConfirmedHistory> confirmed;
+
+    bool isDuplicate(uint16_t deviceId, uint16_t seq) const {
+        auto node = confirmed.find(deviceId);
+        if (node == confirmed.end()) {
+            return false;
+        }
+        for (uint8_t i = 0; i < node->second.count; i++) {
+            if (node->second.seqs[i] == seq) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void rememberConfirmed(uint16_t deviceId, uint16_t seq) {
+        ConfirmedHistory& node = confirmed[deviceId];
+        node.seqs[node.next] = seq;
+        node.next = (node.next + 1) % REPORT_CONFIRMED_HISTORY;
+        if (node.count < REPORT_CONFIRMED_HISTORY) {
+            node.count++;
+        }
+    }
+
+    const Report* find(uint16_t deviceId, uint8_t seq) const {
+        auto node = nodes.find(deviceId);
+        if (node == nodes.end()) {
+            return NULL;
+        }
+        uint8_t slot = seq % REPORT_REFERENCE_HISTORY;
+        if (!node->second.valid[slot] || node->second.reports[slot].seq != seq) {
+            return NULL;
+        }
+        return &node->second.reports[slot];
+    }
+
+    void remember(const Report& report) {
+        NodeHistory& node = nodes[report.deviceId];
+        uint8_t slot = report.seq % REPORT_REFERENCE_HISTORY;
+        node.reports[slot] = report;
+        node.valid[slot] = true;
+    }
+};
+
+#endif
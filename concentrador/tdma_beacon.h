@@ -0,0 +1,70 @@
+/**
+    Header que contiene la baliza de la transmisión por slots (TDMA) del lado del concentrador
+    (ver tdma_helpers.h en el nodo): cada nodo transmite en el slot DEVICE_ID % cantidad de slots
+    de cada trama, por lo que el concentrador elige la cantidad de slots de modo que sus nodos
+    no compartan slot, y un largo de slot que alcance para el tiempo en el aire de un reporte
+    más dos veces TDMA_GUARD.
+    @file tdma_beacon.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef TDMA_BEACON_H
+#define TDMA_BEACON_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+    tdmaSlot() obtiene el slot de un nodo, con la misma fórmula que el nodo.
+    @param deviceId Identificador del nodo.
+    @param slotCount Cantidad de slots por trama.
+    @return Slot del nodo (0 a slotCount - 1).
+*/
+inline uint32_t tdmaSlot(uint16_t deviceId, uint32_t slotCount) {
+    return deviceId % slotCount;
+}
+
+/**
+    tdmaSlotCount() obtiene la menor cantidad de slots (a partir de minimum) con la que ningún
+    par de nodos comparte slot.
+    Por ejemplo, los nodos 20001 a 20200 no comparten slot con 200 slots.
+    @param deviceIds Identificadores de los nodos.
+    @param minimum Cantidad mínima de slots.
+    @param maximum Cantidad máxima de slots.
+    @return Cantidad de slots, ó 0 si ninguna hasta maximum separa a todos los nodos.
+*/
+inline uint32_t tdmaSlotCount(const std::vector<uint16_t>& deviceIds, uint32_t minimum, uint32_t maximum) {
+    for (uint32_t count = std::max<uint32_t>(minimum, deviceIds.size()); count <= maximum; count++) {
+        std::vector<bool> used(count, false);
+        bool collision = false;
+        for (size_t i = 0; i < deviceIds.size() && !collision; i++) {
+            uint32_t slot = tdmaSlot(deviceIds[i], count);
+            collision = used[slot];
+            used[slot] = true;
+        }
+        if (!collision) {
+            return count;
+        }
+    }
+    return 0;
+}
+
+/**
+    beaconCommand() compone la baliza, con el mismo formato que el resto de los comandos LoRa
+    ("<" + BROADCAST_ID + ">" + comando).
+    @param broadcastId ID broadcast de los nodos.
+    @param epoch Tiempo (en ms) transcurrido desde el comienzo de la trama al transmitir la baliza.
+    @param slotLength Duración de cada slot (en ms).
+    @param slotCount Cantidad de slots por trama.
+    @return Comando a transmitir.
+*/
+inline std::string beaconCommand(uint16_t broadcastId, uint32_t epoch, uint32_t slotLength, uint32_t slotCount) {
+    return "<" + std::to_string(broadcastId) + ">bcn" + std::to_string(epoch) + ","
+        + std::to_string(slotLength) + "," + std::to_string(slotCount);
+}
+
+#endif
@@ -0,0 +1,217 @@
+/**
+    Programa que mide el rendimiento de parseTextReport() (ver text_report_parser.h) sobre
+    una captura sintética de reportes de texto, con la forma que compone composeLoRaPayload().
+    Informa paquetes por segundo y nanosegundos por campo (par clave=valor), y compara el buscador de
+    delimitadores SIMD contra la versión byte por byte.
+    Para compilarlo y ejecutarlo:
+        g++ -std=c++11 -O2 -mavx2 text_report_benchmark.cpp -o text_report_benchmark
+        ./text_report_benchmark [cantidad de paquetes] [pasadas]
+    (sin -mavx2 se usa SSE2 en x86-64, y la versión byte por byte en otras arquitecturas).
+    @file text_report_benchmark.cpp
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "text_report_parser.h"
+
+/// Captura sintética.
+#define BENCHMARK_PACKETS 100000            // Cantidad de paquetes por defecto.
+#define BENCHMARK_PASSES 20                 // Pasadas por defecto sobre la captura.
+#define BENCHMARK_UNKNOWN_RATE 8            // Uno de cada 8 campos de GPS se envía como "***".
+#define BENCHMARK_SEED 20009                // Semilla del generador.
+
+/**
+    Capture contiene los paquetes generados, uno a continuación del otro:
+        - bytes: contenido de todos los paquetes.
+        - offsets: posición de inicio de cada paquete (más una al final).
+*/
+struct Capture {
+    std::vector<char> bytes;
+    std::vector<size_t> offsets;
+};
+
+/**
+    nextRandom() genera un número pseudoaleatorio (xorshift32), para que la captura
+    sea la misma en cada ejecución.
+    @param &state Estado del generador (distinto de 0).
+    @return Siguiente número.
+*/
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+    appendFixed() agrega un número en punto fijo con exactamente decimals posiciones decimales,
+    igual que writeFixed() en el nodo.
+    @param &out Texto de salida.
+    @param value Número escalado por 10^decimals.
+    @param decimals Cantidad de posiciones decimales.
+*/
+static void appendFixed(std::vector<char>& out, long value, int decimals) {
+    char digits[24];
+    long scale = 1;
+    for (int i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    unsigned long magnitude = (value < 0) ? -(unsigned long)value : value;
+    int length = (decimals > 0)
+        ? snprintf(digits, sizeof(digits), "%s%lu.%0*lu", value < 0 ? "-" : "", magnitude / scale, decimals, magnitude % scale)
+        : snprintf(digits, sizeof(digits), "%ld", value);
+    out.insert(out.end(), digits, digits + length);
+}
+
+/**
+    appendText() agrega una cadena terminada en '\0'.
+    @param &out Texto de salida.
+    @param text Cadena a agregar.
+*/
+static void appendText(std::vector<char>& out, const char* text) {
+    while (*text != '\0') {
+        out.push_back(*text++);
+    }
+}
+
+/**
+    generateCapture() genera paquetes con valores plausibles para cada campo,
+    incluyendo placeholders "***" en los campos de GPS.
+    @param packets Cantidad de paquetes.
+    @return Captura generada.
+*/
+static Capture generateCapture(size_t packets) {
+    Capture capture;
+    uint32_t state = BENCHMARK_SEED;
+    capture.bytes.reserve(packets * 96);
+    capture.offsets.reserve(packets + 1);
+
+    for (size_t i = 0; i < packets; i++) {
+        capture.offsets.push_back(capture.bytes.size());
+        std::vector<char>& out = capture.bytes;
+        bool gpsUnknown = nextRandom(state) % BENCHMARK_UNKNOWN_RATE == 0;
+
+        out.push_back('<');
+        appendFixed(out, 20000 + nextRandom(state) % 64, 0);
+        appendText(out, ">current=");
+        appendFixed(out, nextRandom(state) % 3000, 2);
+        appendText(out, "&raindrops=");
+        appendFixed(out, (long)(nextRandom(state) % 3) - 1, 0);
+        appendText(out, "&gas=");
+        appendFixed(out, nextRandom(state) % 15000, 2);
+        appendText(out, "/150&lat=");
+        if (gpsUnknown) {
+            appendText(out, "***&lng=***&alt=***");
+        } else {
+            appendFixed(out, -3400000 - (long)(nextRandom(state) % 100000), 5);
+            appendText(out, "&lng=");
+            appendFixed(out, -5800000 - (long)(nextRandom(state) % 100000), 5);
+            appendText(out, "&alt=");
+            appendFixed(out, nextRandom(state) % 120, 0);
+        }
+        appendText(out, "&airtime=");
+        appendFixed(out, nextRandom(state) % 360, 1);
+    }
+    capture.offsets.push_back(capture.bytes.size());
+    return capture;
+}
+
+/**
+    elapsedNanoseconds() obtiene el tiempo transcurrido desde start.
+    @param start Instante inicial.
+    @return Nanosegundos transcurridos.
+*/
+static double elapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t packets = (argc > 1) ? strtoul(argv[1], NULL, 10) : BENCHMARK_PACKETS;
+    int passes = (argc > 2) ? atoi(argv[2]) : BENCHMARK_PASSES;
+    if (packets == 0 || passes <= 0) {
+        fprintf(stderr, "Uso: %s [cantidad de paquetes] [pasadas]\n", argv[0]);
+        return 1;
+    }
+
+    Capture capture = generateCapture(packets);
+    const char* bytes = capture.bytes.data();
+    printf("Captura: %zu paquetes, %zu bytes (%.1f bytes por paquete)\n",
+           packets, capture.bytes.size(), (double)capture.bytes.size() / packets);
+#if defined(__AVX2__)
+    printf("Buscador de delimitadores: AVX2\n");
+#elif defined(__SSE2__)
+    printf("Buscador de delimitadores: SSE2\n");
+#else
+    printf("Buscador de delimitadores: byte por byte\n");
+#endif
+
+    // Verificación: ambos buscadores deben encontrar los mismos delimitadores, y cada paquete
+    // debe tener un par clave=valor por cada campo de TEXT_FIELD_PAIRS.
+    uint16_t simdOffsets[TEXT_REPORT_MAX_DELIMITERS];
+    uint16_t scalarOffsets[TEXT_REPORT_MAX_DELIMITERS];
+    TextReport report;
+    for (size_t i = 0; i < packets; i++) {
+        size_t len = capture.offsets[i + 1] - capture.offsets[i];
+        size_t simdCount = scanDelimiters(bytes + capture.offsets[i], len, simdOffsets, TEXT_REPORT_MAX_DELIMITERS);
+        size_t scalarCount = scanDelimitersScalar(bytes + capture.offsets[i], len, scalarOffsets, TEXT_REPORT_MAX_DELIMITERS);
+        if (simdCount != scalarCount || memcmp(simdOffsets, scalarOffsets, simdCount * sizeof(uint16_t)) != 0) {
+            fprintf(stderr, "Los buscadores difieren en el paquete %zu\n", i);
+            return 1;
+        }
+        if (!parseTextReport(bytes + capture.offsets[i], len, report)
+                || report.fields != __builtin_popcount(TEXT_FIELD_PAIRS)) {
+            fprintf(stderr, "El paquete %zu no tiene los %d pares de TEXT_FIELD_PAIRS\n", i, __builtin_popcount(TEXT_FIELD_PAIRS));
+            return 1;
+        }
+    }
+
+    // Decodificación completa.
+    uint64_t fields = 0;
+    uint64_t present = 0;
+    size_t malformed = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < packets; i++) {
+            size_t len = capture.offsets[i + 1] - capture.offsets[i];
+            if (!parseTextReport(bytes + capture.offsets[i], len, report)) {
+                malformed++;
+            }
+            fields += report.fields;
+            present += __builtin_popcount(report.present & TEXT_FIELD_PAIRS);
+        }
+    }
+    double parseNs = elapsedNanoseconds(start);
+
+    // Sólo la búsqueda de delimitadores, con cada buscador.
+    uint64_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < packets; i++) {
+            size_t len = capture.offsets[i + 1] - capture.offsets[i];
+            checksum += scanDelimiters(bytes + capture.offsets[i], len, simdOffsets, TEXT_REPORT_MAX_DELIMITERS);
+        }
+    }
+    double simdNs = elapsedNanoseconds(start);
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < packets; i++) {
+            size_t len = capture.offsets[i + 1] - capture.offsets[i];
+            checksum += scanDelimitersScalar(bytes + capture.offsets[i], len, scalarOffsets, TEXT_REPORT_MAX_DELIMITERS);
+        }
+    }
+    double scalarNs = elapsedNanoseconds(start);
+
+    double total = (double)packets * passes;
+    printf("Decodificación: %.0f paquetes/s, %.1f ns/paquete, %.2f ns/campo (%zu mal formados)\n",
+           total * 1e9 / parseNs, parseNs / total, parseNs / fields, malformed);
+    printf("Campos presentes (distintos de \"***\"): %.2f de %.2f por paquete\n", (double)present / total, (double)fields / total);
+    printf("Búsqueda de delimitadores: %.1f ns/paquete (SIMD), %.1f ns/paquete (byte por byte) [%llu]\n",
+           simdNs / total, scalarNs / total, (unsigned long long)checksum);
+    return malformed == 0 ? 0 : 1;
+}
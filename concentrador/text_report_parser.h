@@ -0,0 +1,316 @@
+/**
+    Header que contiene el decodificador de alto rendimiento de los reportes de texto
+    ("<20009>current=0.65&raindrops=1&gas=123.52/150&lat=-34.57475&lng=-58.43552&alt=15&airtime=23.2")
+    que compone composeLoRaPayload() en el nodo.
+    Los delimitadores ('>', '=', '&') se buscan de a 16 bytes (SSE2) o 32 bytes (AVX2) y los
+    campos se extraen sin reservar memoria: sólo se guardan posiciones dentro del paquete.
+    Compila con cualquier compilador C++11; las rutas SIMD se habilitan con -msse2 / -mavx2.
+    @file text_report_parser.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef TEXT_REPORT_PARSER_H
+#define TEXT_REPORT_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
+/// Límites.
+#define TEXT_REPORT_MAX_DELIMITERS 64       // Máxima cantidad de delimitadores por paquete.
+
+/// Flags de TextReport::present (un campo con "***" o ausente no tiene su flag).
+#define TEXT_FIELD_DEVICE_ID (1 << 0)
+#define TEXT_FIELD_CURRENT (1 << 1)
+#define TEXT_FIELD_RAINDROPS (1 << 2)
+#define TEXT_FIELD_GAS (1 << 3)
+#define TEXT_FIELD_CAPACITY (1 << 4)
+#define TEXT_FIELD_LAT (1 << 5)
+#define TEXT_FIELD_LNG (1 << 6)
+#define TEXT_FIELD_ALT (1 << 7)
+#define TEXT_FIELD_AIRTIME (1 << 8)
+/// Campos que tienen su propio par clave=valor (deviceId va entre "<>" y capacity comparte el par de gas).
+#define TEXT_FIELD_PAIRS (TEXT_FIELD_CURRENT | TEXT_FIELD_RAINDROPS | TEXT_FIELD_GAS | TEXT_FIELD_LAT \
+                          | TEXT_FIELD_LNG | TEXT_FIELD_ALT | TEXT_FIELD_AIRTIME)
+
+/**
+    TextReport contiene un reporte de texto decodificado, en punto fijo:
+        - present: flags TEXT_FIELD_* de los campos presentes (distintos de "***").
+        - fields: cantidad de pares clave=valor encontrados.
+        - deviceId: identificador del nodo.
+        - current: corriente (en cA).
+        - raindrops: resultado de la votación de lluvia (-1, 0 ó 1).
+        - gas: combustible (en cL).
+        - capacity: capacidad del tanque (en L).
+        - lat, lng: posición (en 1e-7 grados).
+        - alt: altitud (en m).
+        - airtime: tiempo en el aire consumido en la ventana del ciclo de trabajo (en ds).
+*/
+struct TextReport {
+    uint16_t present;
+    uint8_t fields;
+    uint32_t deviceId;
+    int32_t current;
+    int8_t raindrops;
+    int32_t gas;
+    int32_t capacity;
+    int32_t lat;
+    int32_t lng;
+    int32_t alt;
+    int32_t airtime;
+};
+
+/**
+    scanDelimitersScalar() busca las posiciones de '>', '=' y '&' recorriendo byte por byte.
+    Es la referencia de scanDelimiters() y la ruta usada cuando no hay SIMD.
+    @param data Paquete.
+    @param len Cantidad de bytes del paquete.
+    @param offsets Posiciones encontradas.
+    @param maxOffsets Capacidad de offsets.
+    @return Cantidad de delimitadores encontrados (a lo sumo maxOffsets).
+*/
+inline size_t scanDelimitersScalar(const char* data, size_t len, uint16_t offsets[], size_t maxOffsets) {
+    size_t count = 0;
+    for (size_t i = 0; i < len && count < maxOffsets; i++) {
+        char c = data[i];
+        if (c == '>' || c == '=' || c == '&') {
+            offsets[count++] = (uint16_t)i;
+        }
+    }
+    return count;
+}
+
+/**
+    appendMaskOffsets() agrega a offsets las posiciones de los bits en 1 de una máscara de bloque.
+    @param mask Máscara (bit i en 1 si el byte base + i es delimitador).
+    @param base Posición del primer byte del bloque.
+    @param offsets Posiciones encontradas.
+    @param count Cantidad de posiciones ya encontradas.
+    @param maxOffsets Capacidad de offsets.
+    @return Nueva cantidad de posiciones.
+*/
+inline size_t appendMaskOffsets(uint32_t mask, size_t base, uint16_t offsets[], size_t count, size_t maxOffsets) {
+    while (mask != 0 && count < maxOffsets) {
+        offsets[count++] = (uint16_t)(base + __builtin_ctz(mask));
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+/**
+    scanDelimiters() busca las posiciones de '>', '=' y '&' comparando 32 (AVX2) ó 16 (SSE2)
+    bytes por instrucción; el resto del paquete se recorre byte por byte.
+    Nunca lee fuera de [data, data + len).
+    @param data Paquete.
+    @param len Cantidad de bytes del paquete.
+    @param offsets Posiciones encontradas, en orden creciente.
+    @param maxOffsets Capacidad de offsets.
+    @return Cantidad de delimitadores encontrados (a lo sumo maxOffsets).
+*/
+inline size_t scanDelimiters(const char* data, size_t len, uint16_t offsets[], size_t maxOffsets) {
+    size_t count = 0;
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i gt = _mm256_set1_epi8('>');
+    const __m256i eq = _mm256_set1_epi8('=');
+    const __m256i amp = _mm256_set1_epi8('&');
+    for (; i + 32 <= len && count < maxOffsets; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, gt), _mm256_cmpeq_epi8(block, eq)),
+                                       _mm256_cmpeq_epi8(block, amp));
+        count = appendMaskOffsets((uint32_t)_mm256_movemask_epi8(hits), i, offsets, count, maxOffsets);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i gt16 = _mm_set1_epi8('>');
+    const __m128i eq16 = _mm_set1_epi8('=');
+    const __m128i amp16 = _mm_set1_epi8('&');
+    for (; i + 16 <= len && count < maxOffsets; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, gt16), _mm_cmpeq_epi8(block, eq16)),
+                                    _mm_cmpeq_epi8(block, amp16));
+        count = appendMaskOffsets((uint32_t)_mm_movemask_epi8(hits), i, offsets, count, maxOffsets);
+    }
+#endif
+    if (i < len && count < maxOffsets) {
+        size_t tail = scanDelimitersScalar(data + i, len - i, offsets + count, maxOffsets - count);
+        for (size_t j = count; j < count + tail; j++) {
+            offsets[j] += (uint16_t)i;
+        }
+        count += tail;
+    }
+    return count;
+}
+
+/**
+    parseFixedText() convierte un número decimal en texto ("-34.57475") a punto fijo,
+    truncando los decimales que sobren.
+    Por ejemplo:
+        parseFixedText("-34.57475", end, 7, value)
+    devuelve true y value = -345747500.
+    @param begin Primer carácter del número.
+    @param end Posición siguiente al último carácter.
+    @param decimals Posiciones decimales del resultado.
+    @param &value Número escalado por 10^decimals.
+    @return false si el texto está vacío, es "***" o no es un número.
+*/
+inline bool parseFixedText(const char* begin, const char* end, int decimals, int32_t& value) {
+    bool negative = false;
+    if (begin < end && (*begin == '-' || *begin == '+')) {
+        negative = (*begin == '-');
+        begin++;
+    }
+    if (begin == end) {
+        return false;
+    }
+    int64_t result = 0;
+    int fraction = -1;
+    bool digits = false;
+    for (const char* p = begin; p < end; p++) {
+        if (*p >= '0' && *p <= '9') {
+            if (fraction < decimals) {
+                result = result * 10 + (*p - '0');
+                if (fraction >= 0) {
+                    fraction++;
+                }
+            }
+            digits = true;
+            if (result > INT32_MAX) {
+                return false;
+            }
+        } else if (*p == '.' && fraction < 0) {
+            fraction = 0;
+        } else {
+            return false;
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+    for (int i = (fraction < 0 ? 0 : fraction); i < decimals; i++) {
+        result *= 10;
+        if (result > INT32_MAX) {
+            return false;
+        }
+    }
+    value = (int32_t)(negative ? -result : result);
+    return true;
+}
+
+/**
+    keyIs() compara una clave delimitada con un literal, sin reservar memoria.
+    @param begin Primer carácter de la clave.
+    @param length Largo de la clave.
+    @param literal Clave esperada.
+    @param literalLength Largo de la clave esperada.
+    @return true si son iguales.
+*/
+inline bool keyIs(const char* begin, size_t length, const char* literal, size_t literalLength) {
+    return length == literalLength && memcmp(begin, literal, length) == 0;
+}
+
+/**
+    parseTextReport() decodifica un reporte de texto. Las claves desconocidas se ignoran
+    y los valores "***" dejan su campo ausente (sin flag en present).
+    Por ejemplo:
+        TextReport report;
+        if (parseTextReport(packet, packetLength, report) && (report.present & TEXT_FIELD_LAT)) {
+            ...
+        }
+    @param data Paquete recibido.
+    @param len Cantidad de bytes del paquete.
+    @param &report Reporte decodificado.
+    @return false si el paquete no tiene la forma "<id>clave=valor&...".
+*/
+inline bool parseTextReport(const char* data, size_t len, TextReport& report) {
+    uint16_t offsets[TEXT_REPORT_MAX_DELIMITERS];
+    size_t count = scanDelimiters(data, len, offsets, TEXT_REPORT_MAX_DELIMITERS);
+
+    report.present = 0;
+    report.fields = 0;
+    if (len < 2 || data[0] != '<' || count == 0 || data[offsets[0]] != '>') {
+        return false;
+    }
+
+    int32_t value;
+    if (parseFixedText(data + 1, data + offsets[0], 0, value) && value >= 0) {
+        report.deviceId = (uint32_t)value;
+        report.present |= TEXT_FIELD_DEVICE_ID;
+    }
+
+    // Después del '>', los delimitadores alternan '=' (fin de clave) y '&' (fin de valor).
+    size_t keyBegin = offsets[0] + 1;
+    for (size_t i = 1; i < count; i += 2) {
+        if (data[offsets[i]] != '=') {
+            return false;
+        }
+        size_t valueBegin = offsets[i] + 1;
+        size_t valueEnd = (i + 1 < count) ? offsets[i + 1] : len;
+        if (i + 1 < count && data[valueEnd] != '&') {
+            return false;
+        }
+        const char* key = data + keyBegin;
+        size_t keyLength = offsets[i] - keyBegin;
+        const char* begin = data + valueBegin;
+        const char* end = data + valueEnd;
+
+        switch (keyLength) {
+            case 3:
+                if (keyIs(key, keyLength, "gas", 3)) {
+                    const char* slash = (const char*)memchr(begin, '/', end - begin);
+                    if (parseFixedText(begin, slash ? slash : end, 2, value)) {
+                        report.gas = value;
+                        report.present |= TEXT_FIELD_GAS;
+                    }
+                    if (slash && parseFixedText(slash + 1, end, 0, value)) {
+                        report.capacity = value;
+                        report.present |= TEXT_FIELD_CAPACITY;
+                    }
+                } else if (keyIs(key, keyLength, "lat", 3)) {
+                    if (parseFixedText(begin, end, 7, value)) {
+                        report.lat = value;
+                        report.present |= TEXT_FIELD_LAT;
+                    }
+                } else if (keyIs(key, keyLength, "lng", 3)) {
+                    if (parseFixedText(begin, end, 7, value)) {
+                        report.lng = value;
+                        report.present |= TEXT_FIELD_LNG;
+                    }
+                } else if (keyIs(key, keyLength, "alt", 3)) {
+                    if (parseFixedText(begin, end, 0, value)) {
+                        report.alt = value;
+                        report.present |= TEXT_FIELD_ALT;
+                    }
+                }
+                break;
+            case 7:
+                if (keyIs(key, keyLength, "current", 7) && parseFixedText(begin, end, 2, value)) {
+                    report.current = value;
+                    report.present |= TEXT_FIELD_CURRENT;
+                } else if (keyIs(key, keyLength, "airtime", 7) && parseFixedText(begin, end, 1, value)) {
+                    report.airtime = value;
+                    report.present |= TEXT_FIELD_AIRTIME;
+                }
+                break;
+            case 9:
+                if (keyIs(key, keyLength, "raindrops", 9) && parseFixedText(begin, end, 0, value)
+                        && value >= -1 && value <= 1) {
+                    report.raindrops = (int8_t)value;
+                    report.present |= TEXT_FIELD_RAINDROPS;
+                }
+                break;
+        }
+        report.fields++;
+        keyBegin = valueEnd + 1;
+    }
+    // Una clave final sin '=' indica un paquete truncado.
+    return keyBegin >= len;
+}
+
+#endif
@@ -0,0 +1,123 @@
+/**
+    Header que contiene el reensamblado de transferencias fragmentadas del lado del concentrador
+    (ver report_fragments.h). Mantiene a lo sumo una transferencia en curso por nodo, con un
+    buffer de a lo sumo REPORT_FRAGMENT_MAX_COUNT * REPORT_FRAGMENT_MAX_DATA bytes: un fragmento
+    de una transferencia nueva descarta la anterior.
+    @file transfer_assembler.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef TRANSFER_ASSEMBLER_H
+#define TRANSFER_ASSEMBLER_H
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../nodo-sisicic/report_fragments.h"
+
+/**
+    TransferStatus indica el resultado de TransferAssembler::accept().
+*/
+enum TransferStatus {
+    TRANSFER_INCOMPLETE,        // Fragmento nuevo, todavía faltan otros.
+    TRANSFER_COMPLETE,          // Fragmento nuevo que completa la transferencia.
+    TRANSFER_DUPLICATE,         // Fragmento ya recibido.
+    TRANSFER_MALFORMED          // Paquete que no es un fragmento válido.
+};
+
+/**
+    TransferAssembler reensambla las transferencias fragmentadas de múltiples nodos.
+    Por ejemplo:
+        TransferAssembler assembler;
+        FragmentHeader header;
+        if (assembler.accept(packet, packetLength, header) == TRANSFER_COMPLETE) {
+            store(assembler.data(header.deviceId));
+        }
+        if (header.poll) {
+            sendDownlink(assembler.statusCommand(header.deviceId));  // "<20009>frg3,0202"
+        }
+*/
+class TransferAssembler {
+public:
+    /**
+        accept() registra un fragmento y copia sus datos en el buffer de su transferencia.
+        @param buf Paquete recibido.
+        @param len Cantidad de bytes del paquete.
+        @param &header Encabezado del fragmento (válido salvo TRANSFER_MALFORMED).
+        @return Resultado del registro.
+    */
+    TransferStatus accept(const uint8_t buf[], size_t len, FragmentHeader& header) {
+        const uint8_t* data;
+        size_t length;
+        if (!decodeFragment(buf, len, header, data, length)) {
+            return TRANSFER_MALFORMED;
+        }
+        Transfer& transfer = transfers[header.deviceId];
+        uint32_t offset;
+        switch (acceptFragment(transfer.reassembler, header, length, offset)) {
+            case FRAGMENT_DUPLICATE:
+                return TRANSFER_DUPLICATE;
+            case FRAGMENT_MALFORMED:
+                return TRANSFER_MALFORMED;
+        }
+        // Primer fragmento de la transferencia: reserva el peor caso.
+        if (transfer.reassembler.received == 1) {
+            transfer.data.assign((size_t)header.count * header.size, 0);
+        }
+        std::copy(data, data + length, transfer.data.begin() + offset);
+        if (!reassemblyComplete(transfer.reassembler)) {
+            return TRANSFER_INCOMPLETE;
+        }
+        transfer.data.resize(transfer.reassembler.length);
+        return TRANSFER_COMPLETE;
+    }
+
+    /**
+        data() obtiene el bloque reensamblado de un nodo.
+        @param deviceId Identificador del nodo.
+        @return Bloque completo (sólo válido después de TRANSFER_COMPLETE).
+    */
+    const std::vector<uint8_t>& data(uint16_t deviceId) {
+        return transfers[deviceId].data;
+    }
+
+    /**
+        statusCommand() compone el comando con el mapa de fragmentos faltantes de la
+        transferencia en curso de un nodo (ver writeMissingFragments()), con el mismo formato
+        que el resto de los comandos LoRa ("<" + ID + ">" + comando).
+        Un mapa en cero indica que la transferencia está completa.
+        @param deviceId Identificador del nodo.
+        @return Comando a transmitir al nodo.
+    */
+    std::string statusCommand(uint16_t deviceId) {
+        const FragmentReassembler& reassembler = transfers[deviceId].reassembler;
+        char missing[2 * REPORT_FRAGMENT_BITMAP_BYTES + 1];
+        writeMissingFragments(reassembler, missing);
+        return "<" + std::to_string(deviceId) + ">frg" + std::to_string(reassembler.header.transfer) + "," + missing;
+    }
+
+    /**
+        forget() descarta la transferencia en curso de un nodo.
+        @param deviceId Identificador del nodo.
+    */
+    void forget(uint16_t deviceId) {
+        transfers.erase(deviceId);
+    }
+
+private:
+    /**
+        Transfer contiene la transferencia en curso de un nodo y su buffer.
+    */
+    struct Transfer {
+        FragmentReassembler reassembler = FragmentReassembler();
+        std::vector<uint8_t> data;
+    };
+
+    std::unordered_map<uint16_t, Transfer> transfers;
+};
+
+#endif
@@ -6,27 +6,60 @@
     @version 1.2 29/03/2021
 */
 
+static_assert(INCOMING_FULL_MAX_SIZE <= LORA_RX_SLOT_SIZE, "INCOMING_FULL_MAX_SIZE excede LORA_RX_SLOT_SIZE");
+
+// El canal sale del seq del reporte, que sólo avanza en composeBinaryReport().
+#if defined(LORA_FREQUENCY_HOPPING) && !defined(LORA_BINARY_REPORT)
+    #error "LORA_FREQUENCY_HOPPING requiere LORA_BINARY_REPORT"
+#endif
+
+// El concentrador sólo reconoce (y devuelve la SNR de) los reportes binarios.
+#if defined(LORA_ADR) && !defined(LORA_BINARY_REPORT)
+    #error "LORA_ADR requiere LORA_BINARY_REPORT"
+#endif
+
+#ifdef LORA_IMPLICIT_REPORT
+    #if !defined(LORA_BINARY_REPORT) || defined(LORA_DELTA_REPORT) || defined(LORA_SERIES_REPORT) || defined(LORA_BATCH_REPORT)
+        #error "LORA_IMPLICIT_REPORT requiere LORA_BINARY_REPORT y no admite LORA_DELTA_REPORT, LORA_SERIES_REPORT ni LORA_BATCH_REPORT"
+    #endif
+    // Largo fijo de los paquetes con header implícito: el concentrador escucha con LoRa.receive(IMPLICIT_REPORT_SIZE).
+    #ifdef LORA_PACKED_REPORT
+        #define IMPLICIT_RECORD_SIZE REPORT_PACKED_SIZE
+    #else
+        #define IMPLICIT_RECORD_SIZE REPORT_FULL_SIZE
+    #endif
+    #ifdef LORA_CONFIRMED_REPORT
+        #define IMPLICIT_REPORT_SIZE (REPORT_CONFIRMED_HEADER_SIZE + IMPLICIT_RECORD_SIZE)
+    #else
+        #define IMPLICIT_REPORT_SIZE IMPLICIT_RECORD_SIZE
+    #endif
+#endif
+
 /*
-    onRecieve() es la función por interrupción que se llama cuando
-    existen datos en el buffer LoRa.
+    processIncomingPacket() procesa un paquete LoRa recibido, tomado de la cola de recepción
+    (ver LoRa.popPacket()) fuera de la interrupción: si está dirigido a este nodo,
+    deja su carga útil en incomingPayload.
+    @param packet Paquete recibido (con su RSSI, SNR e instante de recepción).
 */
-void onReceive(int packetSize) {
+void processIncomingPacket(const LoRaPacket& packet) {
     #if DEBUG_LEVEL >= 2
-        Serial.println("Entering recieve mode");
+        Serial.print("Paquete recibido (RSSI, SNR): ");
+        Serial.print(packet.rssi);
+        Serial.print(", ");
+        Serial.println(packet.snr);
     #endif
 
     // Si el tamaño del paquete entrante es nulo,
     // o si es superior al tamaño reservado para la string incomingFull
     // salir de la subrutina.
-    if (packetSize == 0 || packetSize > INCOMING_FULL_MAX_SIZE) {
+    if (packet.length == 0 || packet.length > INCOMING_FULL_MAX_SIZE) {
         return;
     }
 
-    // No se puede utilizar readString() en un callback.
-    // Se añaden los bytes uno por uno.
-    while (LoRa.available()) {
-        incomingFull += (char)LoRa.read();
-    }
+    char text[INCOMING_FULL_MAX_SIZE + 1];
+    memcpy(text, packet.data, packet.length);
+    text[packet.length] = '\0';
+    incomingFull = text;
 
     // Extraer el delimitador ">" para diferenciar el ID del payload.
     int delimiter = incomingFull.indexOf(greaterThanStr);
@@ -60,21 +93,50 @@ void onReceive(int packetSize) {
 /**
     LoRaInitialize() inicializa el módulo SX1278 con:
         - la frecuencia (LORA_FREQ) y la palabra de sincronización (LORA_SYNC_WORD) indicados en constants.h
-        - los pines (NSS_PIN, RESET_PIN, DIO0_PIN) indicados en pinout.h,
-    Además, define la función onRecieve como callback del evento onRecieve.
+        - los pines (NSS_PIN, RESET_PIN, DIO0_PIN y, con LORA_RX_WINDOWS, DIO1_PIN) indicados en pinout.h,
+    Además, habilita la cola de recepción: la interrupción sólo copia cada paquete
+    (ver processIncomingPacket()), y con LORA_LISTEN_BEFORE_TALK la detección
+    de actividad en el canal antes de cada transmisión.
+    Con LORA_RX_WINDOWS la radio duerme en lugar de recibir continuamente, y sólo escucha
+    LORA_RX_WINDOW ms tras cada transmisión (donde llegan el "ack" y los comandos en respuesta)
+    y en las ventanas periódicas que abre loop(). Con LORA_TDMA, las balizas sólo se reciben
+    dentro de esas ventanas.
     Si por algún motivo fallara, "cuelga" al programa.
 */
 void LoRaInitialize() {
-    LoRa.setPins(NSS_PIN, RESET_PIN, DIO0_PIN);
+    #ifdef LORA_RX_WINDOWS
+        LoRa.setPins(NSS_PIN, RESET_PIN, DIO0_PIN, DIO1_PIN);
+    #else
+        LoRa.setPins(NSS_PIN, RESET_PIN, DIO0_PIN);
+    #endif
 
     if (!LoRa.begin(LORA_FREQ)) {
         Serial.println("Starting LoRa failed!");
         blockingAlert(2000, 10);
         while (1);
     }
-    LoRa.setSyncWord(LORA_SYNC_WORD);
-    LoRa.onReceive(onReceive);
-    LoRa.receive();
+    #ifdef LORA_IMPLICIT_REPORT
+        // Los nodos y el concentrador del perfil de header implícito usan su propia palabra
+        // de sincronización, para no recibir paquetes de largo distinto al acordado.
+        LoRa.setSyncWord(LORA_IMPLICIT_SYNC_WORD);
+    #else
+        LoRa.setSyncWord(LORA_SYNC_WORD);
+    #endif
+    #ifdef LORA_CONFIRMED_REPORT
+        confirmedSeq = ((uint16_t)LoRa.random() << 8) | LoRa.random();
+    #endif
+    #ifdef LORA_TRANSFER
+        transferId = LoRa.random();
+    #endif
+    LoRa.enableReceiveQueue();
+    #ifdef LORA_LISTEN_BEFORE_TALK
+        LoRa.enableListenBeforeTalk();
+    #endif
+    #ifdef LORA_RX_WINDOWS
+        LoRa.enableReceiveWindows(LORA_RX_WINDOW);
+    #else
+        LoRa.receive();
+    #endif
 
     #if DEBUG_LEVEL >= 1
         Serial.println("LoRa initialized OK.");
@@ -82,19 +144,16 @@ void LoRaInitialize() {
 }
 
 /**
-    reserveMemory() reserva memoria para las Strings.
+    reserveMemory() reserva memoria para las Strings de recepción
+    (el payload saliente se compone en un buffer estático, ver composeLoRaPayload()).
     En caso de quedarse sin memoria, alerta por puerto serial
     e inicia una alerta de falla
 */
 void reserveMemory() {
     receiverStr.reserve(DEVICE_ID_MAX_SIZE);
     incomingPayload.reserve(INCOMING_PAYLOAD_MAX_SIZE);
-    incomingFull.reserve(INCOMING_FULL_MAX_SIZE);
-    latStr.reserve(5 + GPS_DECIMAL_POSITIONS);
-    lngStr.reserve(5 + GPS_DECIMAL_POSITIONS);
-    altStr.reserve(5);
 
-    if (!outcomingFull.reserve(MAX_SIZE_OUTCOMING_LORA_REPORT)) {
+    if (!incomingFull.reserve(INCOMING_FULL_MAX_SIZE)) {
         #if DEBUG_LEVEL >= 1
             Serial.println("Strings out of memory!");
         #endif
@@ -104,8 +163,9 @@ void reserveMemory() {
 }
 
 /**
-    composeLoRaPayload() se encarga de crear la string de carga útil de LoRa,
-    a partir de los estados actuales de los sensores.
+    composeLoRaPayload() se encarga de escribir la carga útil de texto de LoRa
+    en un buffer de bytes, a partir de los estados actuales de los sensores.
+    No utiliza memoria heap: los números se formatean en punto fijo (ver buffer_helpers.h).
     Por ejemplo, si:
         DEVICE_ID = 20009
         cts = {0.50, 0.80, 0.65}
@@ -115,83 +175,748 @@ void reserveMemory() {
         GPS.location.lat() = -34.574749127
         GPS.location.lng() = 58.43552318
         GPS.location.alt() = 15.62
-    Entonces, esta función sobreescribe la String a retornar con:
-        "<20009>current=0.65&raindrops=1&gas=123.51/150&lat=-34.57475&lng=58.43552&alt=15"
+        consumedAirtime() = 2315
+    Entonces, esta función escribe en el buffer:
+        "<20009>current=0.65&raindrops=1&gas=123.52/150&lat=-34.57475&lng=58.43552&alt=15&airtime=23.2"
     @param cts Array con los valores de medición de corriente.
     @param rain Array con los valores de medición de lluvia.
     @param gas Número con coma flotante con la medición de combustible.
-    @param &rtn Dirección de memoria de la String a componer.
+    @param buf Buffer de salida.
+    @param maxLen Tamaño del buffer de salida.
+    @return Cantidad de bytes escritos (listos para LoRa.write(buf, len)).
 */
-void composeLoRaPayload(float cts[], int rain[], float gas, String& rtn) {
-    int altitude;
+size_t composeLoRaPayload(float cts[], int rain[], float gas, uint8_t buf[], size_t maxLen) {
+    size_t pos = 0;
 
     // Payload LoRA = vector de bytes transmitidos en forma FIFO.
     // | Dev ID | Corriente | Lluvia | Combustible/capacidad | Latitud | Longitud | Altitud |
-    rtn = "<";
+    pos = writeText(buf, pos, maxLen, "<");
     #ifdef DEVICE_ID
-        rtn += ((int)DEVICE_ID);
+        pos = writeInteger(buf, pos, maxLen, DEVICE_ID);
     #else
-        rtn += "***";
+        pos = writeText(buf, pos, maxLen, "***");
     #endif
-    rtn += ">";
+    pos = writeText(buf, pos, maxLen, ">");
 
-    rtn += "current";
-    rtn += "=";
-    rtn += round2decimals(compressArray(cts, ARRAY_SIZE));
+    pos = writeText(buf, pos, maxLen, "current=");
+    pos = writeFixed(buf, pos, maxLen, scaleRound(compressArray(cts, ARRAY_SIZE), 100, 0, LONG_MAX), 2);
 
-    rtn += "&";
-    rtn += "raindrops";
-    rtn += "=";
+    pos = writeText(buf, pos, maxLen, "&raindrops=");
     #ifndef RAINDROP_MOCK
-        rtn += compressArray(rain, ARRAY_SIZE);
+        pos = writeInteger(buf, pos, maxLen, compressArray(rain, ARRAY_SIZE));
     #else
-        rtn += ((int)RAINDROP_MOCK);
+        pos = writeInteger(buf, pos, maxLen, RAINDROP_MOCK);
     #endif
 
-    rtn += "&";
-    rtn += "gas";
-    rtn += "=";
+    pos = writeText(buf, pos, maxLen, "&gas=");
     #ifndef GAS_MOCK
-        rtn += round2decimals(gas);
+        pos = writeFixed(buf, pos, maxLen, scaleRound(gas, 100, LONG_MIN, LONG_MAX), 2);
     #else
-        rtn += round2decimals(GAS_MOCK);
+        pos = writeFixed(buf, pos, maxLen, scaleRound(GAS_MOCK, 100, LONG_MIN, LONG_MAX), 2);
     #endif
 
-    rtn += "/";
+    pos = writeText(buf, pos, maxLen, "/");
     #ifdef CAPACIDAD_COMBUSTIBLE
-        rtn += ((int)CAPACIDAD_COMBUSTIBLE);
+        pos = writeInteger(buf, pos, maxLen, CAPACIDAD_COMBUSTIBLE);
     #else
-        rtn += "***";
+        pos = writeText(buf, pos, maxLen, "***");
     #endif
 
     #ifndef GPS_MOCK
+        // La posición se lee en 1e-7 grados (sin pasar por double) y se lleva a GPS_DECIMAL_POSITIONS.
+        const long gpsDivisor = decimalScale(7 - GPS_DECIMAL_POSITIONS);
         if (GPS.location.isValid()) {
-            latStr = String(GPS.location.lat(), GPS_DECIMAL_POSITIONS);
-            lngStr = String(GPS.location.lng(), GPS_DECIMAL_POSITIONS);
-            altStr = String((int)GPS.altitude.meters());
+            pos = writeText(buf, pos, maxLen, "&lat=");
+            pos = writeFixed(buf, pos, maxLen, divideRounded(GPS.location.latE7(), gpsDivisor), GPS_DECIMAL_POSITIONS);
+            pos = writeText(buf, pos, maxLen, "&lng=");
+            pos = writeFixed(buf, pos, maxLen, divideRounded(GPS.location.lngE7(), gpsDivisor), GPS_DECIMAL_POSITIONS);
+            pos = writeText(buf, pos, maxLen, "&alt=");
+            pos = writeInteger(buf, pos, maxLen, GPS.altitude.value() / 100);
         } else {
-            latStr = "***";
-            lngStr = "***";
-            altStr = "***";
+            pos = writeText(buf, pos, maxLen, "&lat=***&lng=***&alt=***");
+        }
+    #else
+        const long gpsScale = decimalScale(GPS_DECIMAL_POSITIONS);
+        pos = writeText(buf, pos, maxLen, "&lat=");
+        pos = writeFixed(buf, pos, maxLen, scaleRound(GPS_MOCK[0], gpsScale, LONG_MIN, LONG_MAX), GPS_DECIMAL_POSITIONS);
+        pos = writeText(buf, pos, maxLen, "&lng=");
+        pos = writeFixed(buf, pos, maxLen, scaleRound(GPS_MOCK[1], gpsScale, LONG_MIN, LONG_MAX), GPS_DECIMAL_POSITIONS);
+        pos = writeText(buf, pos, maxLen, "&alt=");
+        pos = writeInteger(buf, pos, maxLen, (long)GPS_MOCK[2]);
+    #endif
+
+    // Tiempo en el aire consumido en la ventana del ciclo de trabajo (en s).
+    pos = writeText(buf, pos, maxLen, "&airtime=");
+    pos = writeFixed(buf, pos, maxLen, divideRounded(consumedAirtime(), 100), 1);
+
+    return pos;
+}
+
+static_assert(REPORT_PACKED_SIZE <= LORA_TX_MAX_PACKET, "PackedReportSchema no entra en la cola de transmisión LoRa");
+static_assert(REPORT_PACKED_SIZE <= MAX_SIZE_OUTCOMING_LORA_REPORT, "PackedReportSchema no entra en outcomingBuffer");
+
+/**
+    Fuentes de los campos de report_fields.h: cada una escribe en el Report el valor actual
+    de su sensor (o su valor mock), con las mismas reglas que composeLoRaPayload().
+    La posición se lee en punto fijo (latE7(), lngE7() y altitude.value() en cm), sin pasar por double.
+*/
+void CurrentField::read(Report& report) {
+    report.current = scaleRound(compressArray(currents, ARRAY_SIZE), 100, 0, UINT16_MAX);
+}
+
+void RaindropsField::read(Report& report) {
+    #ifndef RAINDROP_MOCK
+        report.raindrops = compressArray(raindrops, ARRAY_SIZE);
+    #else
+        report.raindrops = RAINDROP_MOCK;
+    #endif
+}
+
+void GasField::read(Report& report) {
+    #ifndef GAS_MOCK
+        report.gas = scaleRound(gas, 10, 0, UINT16_MAX);
+    #else
+        report.gas = scaleRound(GAS_MOCK, 10, 0, UINT16_MAX);
+    #endif
+}
+
+void LatField::read(Report& report) {
+    #ifndef GPS_MOCK
+        report.lat = GPS.location.isValid() ? GPS.location.latE7() : REPORT_UNKNOWN_COORD;
+    #else
+        report.lat = scaleRound(GPS_MOCK[0], 10000000L, -1800000000L, 1800000000L);
+    #endif
+}
+
+void LngField::read(Report& report) {
+    #ifndef GPS_MOCK
+        report.lng = GPS.location.isValid() ? GPS.location.lngE7() : REPORT_UNKNOWN_COORD;
+    #else
+        report.lng = scaleRound(GPS_MOCK[1], 10000000L, -1800000000L, 1800000000L);
+    #endif
+}
+
+void AltField::read(Report& report) {
+    #ifndef GPS_MOCK
+        report.alt = GPS.location.isValid()
+            ? constrain(divideRounded(GPS.altitude.value(), 100), INT16_MIN + 1, INT16_MAX)
+            : REPORT_UNKNOWN_ALT;
+    #else
+        report.alt = scaleRound(GPS_MOCK[2], 1, INT16_MIN + 1, INT16_MAX);
+    #endif
+}
+
+void AirtimeField::read(Report& report) {
+    report.airtime = min(divideRounded(consumedAirtime(), 100), (int32_t)UINT16_MAX);
+}
+
+/**
+    fillReport() se encarga de completar un reporte binario (ver report_helpers.h)
+    a partir de los estados actuales de los sensores, leyendo la fuente de cada campo
+    habilitado en PackedReportSchema (ver report_fields.h). Los campos deshabilitados
+    quedan en 0 o, si son del GPS, como desconocidos.
+    Por ejemplo, con los mismos valores del ejemplo de composeLoRaPayload(), completa:
+        { 20009, seq, 65, 1, 1235, -345747491, 584355231, 15, 23 }
+    @param &report Reporte a completar (conserva su seq).
+*/
+void fillReport(Report& report) {
+    report.deviceId = DEVICE_ID;
+    report.current = 0;
+    report.raindrops = -1;
+    report.gas = 0;
+    report.lat = REPORT_UNKNOWN_COORD;
+    report.lng = REPORT_UNKNOWN_COORD;
+    report.alt = REPORT_UNKNOWN_ALT;
+    report.airtime = 0;
+    PackedReportCodec::fill(report);
+}
+
+/**
+    composeBinaryReport() se encarga de completar el reporte binario a partir de los
+    estados actuales de los sensores, asignarle el siguiente número de secuencia y serializarlo.
+    Si LORA_DELTA_REPORT está definido, serializa un reporte diferencial respecto de referenceReport,
+    salvo que:
+        - todavía no exista un reporte reconocido (referenceValid == false),
+        - la referencia sea más vieja que los REPORT_REFERENCE_HISTORY reportes que recuerda el concentrador,
+        - se hayan enviado DELTA_KEYFRAME_INTERVAL reportes diferenciales seguidos.
+    En esos casos (o si LORA_DELTA_REPORT no está definido) serializa un reporte completo,
+    empaquetado según PackedReportSchema si LORA_PACKED_REPORT está definido.
+    Si LORA_PACKED_REPORT está definido, los campos se cuantizan a la resolución del paquete antes
+    de compararlos con la referencia, para que un nodo quieto con una posición ruidosa no transmita
+    diferencias que el reporte empaquetado no puede representar.
+    @param &report Reporte a completar (conserva el seq del reporte anterior).
+    @param buf Buffer de salida.
+    @return Cantidad de bytes escritos.
+*/
+size_t composeBinaryReport(Report& report, uint8_t buf[]) {
+    fillReport(report);
+    report.seq++;
+    #ifdef LORA_PACKED_REPORT
+        quantizePackedReport(report);
+    #endif
+
+    #ifdef LORA_DELTA_REPORT
+        uint8_t referenceAge = report.seq - referenceReport.seq;
+        if (referenceValid && referenceAge < REPORT_REFERENCE_HISTORY
+                && reportsSinceKeyframe < DELTA_KEYFRAME_INTERVAL) {
+            reportsSinceKeyframe++;
+            return encodeDeltaReport(report, referenceReport, buf);
         }
+        reportsSinceKeyframe = 0;
+    #endif
+
+    #ifdef LORA_PACKED_REPORT
+        return encodePackedReport(report, buf);
     #else
-        latStr = String(GPS_MOCK[0], GPS_DECIMAL_POSITIONS);
-        lngStr = String(GPS_MOCK[1], GPS_DECIMAL_POSITIONS);
-        altStr = String((int)GPS_MOCK[2]);
+        return encodeReport(report, buf);
     #endif
+}
 
-    rtn += "&";
-    rtn += "lat";
-    rtn += "=";
-    rtn += latStr;
+/**
+    acknowledgeReport() se encarga de procesar el reconocimiento de un reporte por parte
+    del concentrador: si seq coincide con el último reporte transmitido, este pasa a ser
+    la referencia de los siguientes reportes diferenciales. Si LORA_ADR está definido,
+    además registra la SNR con que lo recibió el concentrador (ver adr_helpers.h).
+    @param seq Número de secuencia reconocido.
+    @param snr SNR del reporte (en dB), o ADR_SNR_UNKNOWN si el concentrador no la indicó.
+*/
+void acknowledgeReport(long seq, long snr) {
+    if (seq == outcomingReport.seq) {
+        #ifdef LORA_DELTA_REPORT
+            referenceReport = outcomingReport;
+            referenceValid = true;
+        #endif
+        #ifdef LORA_ADR
+            dataRateAcknowledged(snr);
+        #endif
+        #if DEBUG_LEVEL >= 2
+            Serial.print("Reporte reconocido: ");
+            Serial.println(seq);
+        #endif
+    }
+}
+
+#ifdef LORA_SERIES_REPORT
+    static_assert(SERIES_BITS == 8 || SERIES_BITS == 12, "SERIES_BITS debe ser 8 ó 12");
+    static_assert(ARRAY_SIZE <= REPORT_SERIES_MAX_SAMPLES, "ARRAY_SIZE excede REPORT_SERIES_MAX_SAMPLES");
+    static_assert(REPORT_SERIES_SIZE(ARRAY_SIZE, SERIES_BITS) <= LORA_TX_MAX_PACKET, "La serie no entra en la cola de transmisión LoRa");
+    static_assert(REPORT_SERIES_SIZE(ARRAY_SIZE, SERIES_BITS) <= MAX_SIZE_OUTCOMING_LORA_REPORT, "La serie no entra en outcomingBuffer");
+#endif
 
-    rtn += "&";
-    rtn += "lng";
-    rtn += "=";
-    rtn += lngStr;
+/**
+    composeSeriesReport() se encarga de serializar las ARRAY_SIZE muestras de corriente
+    del intervalo (en lugar de su promedio) con SERIES_BITS bits por muestra (ver report_series.h).
+    Las muestras que no llegaron a tomarse se transmiten como 0.
+    @param cts Array con los valores de medición de corriente.
+    @param report Reporte al que acompaña la serie (se toman su deviceId y su seq).
+    @param buf Buffer de salida.
+    @return Cantidad de bytes escritos.
+*/
+size_t composeSeriesReport(float cts[], const Report& report, uint8_t buf[]) {
+    uint16_t samples[ARRAY_SIZE];
+    for (int i = 0; i < ARRAY_SIZE; i++) {
+        samples[i] = scaleRound(cts[i], 100, 0, UINT16_MAX);
+    }
+    return encodeSeriesReport(report.deviceId, report.seq, samples, ARRAY_SIZE, SERIES_BITS, buf);
+}
 
-    rtn += "&";
-    rtn += "alt";
-    rtn += "=";
-    rtn += altStr;
+/**
+    sendLoRaPacket() encola un paquete LoRa con el contenido de un buffer (ver LoRa.enqueuePacket()).
+    La transmisión no bloquea: al terminar, la interrupción TxDone transmite el siguiente
+    paquete encolado o vuelve a poner al módulo en modo recepción continua.
+    Si el tiempo en el aire del paquete excediera el presupuesto del ciclo de trabajo
+    (ver airtime_helpers.h), no lo transmite. Antes de encolarlo, configura la potencia
+    que haya elegido el ADR (ver applyDataRate()).
+    Si LORA_IMPLICIT_REPORT está definido, lo transmite con header implícito, por lo que
+    sólo admite paquetes de IMPLICIT_REPORT_SIZE bytes (la recepción sigue usando header explícito).
+    Si LORA_FREQUENCY_HOPPING está definido, lo transmite en el canal del seq del reporte actual
+    (ver channel_plan.h); la recepción sigue en LORA_FREQ.
+    @param buf Buffer a transmitir (se copia, por lo que puede reutilizarse enseguida).
+    @param length Cantidad de bytes a transmitir.
+    @return true si el paquete quedó encolado.
+*/
+bool sendLoRaPacket(const uint8_t buf[], size_t length) {
+    #ifdef LORA_ADR
+        applyDataRate();
+    #endif
+    if (!dutyCycleAllows(length)) {
+        #if DEBUG_LEVEL >= 1
+            Serial.println("Paquete LoRa postergado por ciclo de trabajo!");
+        #endif
+        return false;
+    }
+
+    #ifdef LORA_IMPLICIT_REPORT
+        if (length != IMPLICIT_REPORT_SIZE) {
+            #if DEBUG_LEVEL >= 1
+                Serial.println("Paquete LoRa descartado por largo (header implícito)!");
+            #endif
+            return false;
+        }
+        const bool implicitHeader = true;
+    #else
+        const bool implicitHeader = false;
+    #endif
+
+    #ifdef LORA_FREQUENCY_HOPPING
+        const long frequency = hopFrequency(DEVICE_ID, outcomingReport.seq);
+    #else
+        const long frequency = 0;
+    #endif
+
+    LoRa.resetSpiTransactions();
+    if (!LoRa.enqueuePacket(buf, length, implicitHeader, frequency)) {
+        #if DEBUG_LEVEL >= 1
+            Serial.println("Cola de transmisión LoRa llena!");
+        #endif
+        return false;
+    }
+    accountAirtime(length);
+
+    #if DEBUG_LEVEL >= 2
+        Serial.print("Transacciones SPI: ");
+        Serial.println(LoRa.spiTransactions());
+        Serial.print("Tiempo en el aire en la ventana (ms): ");
+        Serial.println(consumedAirtime());
+    #endif
+    return true;
+}
+
+#ifdef LORA_BATCH_REPORT
+/**
+    closeBatch() se encarga de completar la antigüedad de cada registro del lote
+    y de vaciarlo, dejándolo listo para transmitir desde batchBuffer.
+    @return Cantidad de bytes del lote.
+*/
+size_t closeBatch() {
+    unsigned long now = millis();
+    size_t pos = REPORT_BATCH_HEADER_SIZE;
+    for (uint8_t i = 0; i < batchBuffer[3]; i++) {
+        putU16(batchBuffer, pos, min((now - batchStamps[i]) / 1000, (unsigned long)UINT16_MAX));
+        pos += REPORT_BATCH_RECORD_OVERHEAD + batchBuffer[pos + 2];
+    }
+    size_t length = batchLength;
+    batchLength = 0;
+    #if DEBUG_LEVEL >= 1
+        Serial.print("Lote LoRa encolado! (bytes): ");
+        Serial.println(length);
+    #endif
+    return length;
+}
+
+/**
+    batchDue() determina si el lote debe transmitirse ahora: porque alcanzó LORA_BATCH_SIZE
+    registros o porque, si esperara al próximo intervalo (TIMEOUT_LORA), su registro más viejo
+    superaría BATCH_MAX_DELAY segundos de antigüedad.
+    Mientras el lote no entre en el presupuesto del ciclo de trabajo, se posterga y sigue
+    agrupando registros.
+    @return true si el lote no está vacío y debe transmitirse.
+*/
+bool batchDue() {
+    if (batchLength == 0 || !dutyCycleAllows(batchLength)) {
+        return false;
+    }
+    unsigned long oldestAge = millis() - batchStamps[0];
+    return batchBuffer[3] >= LORA_BATCH_SIZE || oldestAge + sec2ms(TIMEOUT_LORA) > sec2ms(BATCH_MAX_DELAY);
+}
+#endif
+
+/**
+    transmitReport() se encarga de transmitir un reporte. Si LORA_BATCH_REPORT está definido,
+    en lugar de transmitirlo lo agrega como registro al lote (transmitiendo antes el lote
+    pendiente si el registro no entrara en él); el lote se transmite luego con closeBatch().
+    @param buf Reporte a transmitir.
+    @param length Cantidad de bytes del reporte.
+    @return true si el reporte quedó encolado (false si lo impidió el ciclo de trabajo).
+*/
+bool transmitReport(const uint8_t buf[], size_t length) {
+    #ifdef LORA_BATCH_REPORT
+        if (batchLength > 0 && (batchBuffer[3] >= LORA_BATCH_SIZE
+                || batchLength + REPORT_BATCH_RECORD_OVERHEAD + length > LORA_TX_MAX_PACKET)) {
+            // Si el lote lleno no entra en el ciclo de trabajo, se conserva y se descarta el reporte.
+            if (!dutyCycleAllows(batchLength)) {
+                return false;
+            }
+            sendLoRaPacket(batchBuffer, closeBatch());
+        }
+        if (batchLength == 0) {
+            batchLength = beginBatch(DEVICE_ID, batchBuffer);
+        }
+        batchStamps[batchBuffer[3]] = millis();
+        batchLength = appendBatchRecord(batchBuffer, batchLength, 0, buf, length);
+        return true;
+    #else
+        return sendLoRaPacket(buf, length);
+    #endif
+}
+
+#ifdef LORA_CONFIRMED_REPORT
+    #if !defined(LORA_BINARY_REPORT) || defined(LORA_BATCH_REPORT)
+        #error "LORA_CONFIRMED_REPORT requiere LORA_BINARY_REPORT y no admite LORA_BATCH_REPORT"
+    #endif
+    static_assert(REPORT_FULL_SIZE <= REPORT_DELTA_MAX_SIZE && REPORT_PACKED_SIZE <= REPORT_DELTA_MAX_SIZE,
+                  "El reporte no entra en confirmedBuffer");
+    #ifdef LORA_RX_WINDOWS
+        static_assert(LORA_RX_WINDOW >= CONFIRMED_RX_WINDOW, "LORA_RX_WINDOW debe ser al menos CONFIRMED_RX_WINDOW");
+    #endif
+
+/// Estados del reporte confirmado (confirmedState).
+#define CONFIRMED_IDLE 0            // Sin reporte pendiente de confirmación.
+#define CONFIRMED_SENDING 1         // En la cola de transmisión.
+#define CONFIRMED_WAITING_ACK 2     // Transmitido, esperando "cnf<seq>" hasta confirmedDeadline.
+#define CONFIRMED_WAITING_RETRY 3   // Esperando hasta confirmedDeadline para retransmitirlo.
+
+/**
+    sendConfirmedReport() envuelve un reporte en un reporte confirmado con el siguiente
+    confirmedSeq (ver encodeConfirmedReport()) y lo transmite. Si no llega su confirmación
+    dentro de CONFIRMED_RX_WINDOW ms, callbackConfirmedReport() lo retransmite.
+    Un reporte anterior aún sin confirmar se abandona, ya que el nuevo lo reemplaza.
+    @param buf Reporte a transmitir.
+    @param length Cantidad de bytes del reporte (a lo sumo REPORT_DELTA_MAX_SIZE).
+    @return true si el reporte quedó encolado.
+*/
+bool sendConfirmedReport(const uint8_t buf[], size_t length) {
+    #if DEBUG_LEVEL >= 1
+        if (confirmedState != CONFIRMED_IDLE) {
+            Serial.println("Reporte confirmado reemplazado sin confirmar!");
+        }
+    #endif
+    confirmedLength = encodeConfirmedReport(DEVICE_ID, ++confirmedSeq, buf, length, confirmedBuffer);
+    confirmedRetries = 0;
+    confirmedState = sendLoRaPacket(confirmedBuffer, confirmedLength) ? CONFIRMED_SENDING : CONFIRMED_IDLE;
+    return confirmedState == CONFIRMED_SENDING;
+}
+
+/**
+    confirmReport() se encarga de procesar la confirmación de un reporte confirmado:
+    si seq coincide con el último, deja de retransmitirlo y lo da por reconocido
+    (ver acknowledgeReport()), por lo que el concentrador no necesita enviar además "ack<seq>".
+    @param seq Número de secuencia confirmado.
+    @param snr SNR del reporte (en dB), o ADR_SNR_UNKNOWN si el concentrador no la indicó.
+*/
+void confirmReport(long seq, long snr) {
+    if (confirmedState == CONFIRMED_IDLE || seq != confirmedSeq) {
+        return;
+    }
+    confirmedState = CONFIRMED_IDLE;
+    #if DEBUG_LEVEL >= 2
+        Serial.print("Reporte confirmado (retransmisiones): ");
+        Serial.println(confirmedRetries);
+    #endif
+    acknowledgeReport(outcomingReport.seq, snr);
+}
+
+/**
+    callbackConfirmedReport() se encarga de esperar la confirmación del último reporte confirmado:
+        - la espera de CONFIRMED_RX_WINDOW ms comienza cuando se vacía la cola de transmisión,
+        - si vence sin confirmación, espera entre 1 y 2 veces CONFIRMED_BACKOFF ms (duplicándolos
+          en cada retransmisión) y lo retransmite, hasta CONFIRMED_MAX_RETRIES veces.
+    Si el ciclo de trabajo no permite retransmitirlo, vuelve a esperar CONFIRMED_BACKOFF ms.
+*/
+void callbackConfirmedReport() {
+    switch (confirmedState) {
+        case CONFIRMED_SENDING:
+            if (!LoRa.isTxBusy()) {
+                confirmedDeadline = millis() + CONFIRMED_RX_WINDOW;
+                confirmedState = CONFIRMED_WAITING_ACK;
+            }
+            break;
+        case CONFIRMED_WAITING_ACK:
+            if ((long)(millis() - confirmedDeadline) < 0) {
+                break;
+            }
+            if (confirmedRetries >= CONFIRMED_MAX_RETRIES) {
+                #if DEBUG_LEVEL >= 1
+                    Serial.println("Reporte confirmado sin confirmar!");
+                #endif
+                confirmedState = CONFIRMED_IDLE;
+                break;
+            }
+            confirmedRetries++;
+            {
+                unsigned long backoff = (unsigned long)CONFIRMED_BACKOFF << (confirmedRetries - 1);
+                confirmedDeadline = millis() + random(backoff, 2 * backoff);
+            }
+            confirmedState = CONFIRMED_WAITING_RETRY;
+            break;
+        case CONFIRMED_WAITING_RETRY:
+            if ((long)(millis() - confirmedDeadline) < 0) {
+                break;
+            }
+            if (sendLoRaPacket(confirmedBuffer, confirmedLength)) {
+                confirmedState = CONFIRMED_SENDING;
+            } else {
+                confirmedDeadline = millis() + CONFIRMED_BACKOFF;
+            }
+            break;
+    }
+}
+#endif
+
+#ifdef LORA_TRANSFER
+static_assert(TRANSFER_FRAGMENT_SIZE <= REPORT_FRAGMENT_MAX_DATA, "TRANSFER_FRAGMENT_SIZE excede REPORT_FRAGMENT_MAX_DATA");
+static_assert(REPORT_FRAGMENT_HEADER_SIZE + TRANSFER_FRAGMENT_SIZE <= LORA_TX_MAX_PACKET, "El fragmento no entra en la cola de transmisión LoRa");
+#ifdef LORA_RX_WINDOWS
+    static_assert(LORA_RX_WINDOW >= TRANSFER_STATUS_TIMEOUT, "LORA_RX_WINDOW debe ser al menos TRANSFER_STATUS_TIMEOUT");
+#endif
+
+/// Estados de la transferencia fragmentada (transferState).
+#define TRANSFER_IDLE 0             // Sin transferencia en curso.
+#define TRANSFER_SENDING 1          // Transmitiendo los fragmentos de transferPending.
+#define TRANSFER_POLLING 2          // Fragmento que pide el mapa de faltantes en la cola de transmisión.
+#define TRANSFER_WAITING_STATUS 3   // Esperando "frg<transferencia>,<faltantes>" hasta transferDeadline.
+
+/**
+    beginTransfer() comienza una transferencia fragmentada de un bloque mayor que un paquete LoRa
+    (ver report_fragments.h): callbackTransfer() lo transmite en fragmentos de
+    TRANSFER_FRAGMENT_SIZE bytes, de a uno por vez y sin demorar a los reportes.
+    @param data Bloque a transferir (no se copia: debe permanecer sin cambios hasta que termine).
+    @param length Cantidad de bytes del bloque.
+    @return true si la transferencia comenzó (false si hay otra en curso o el bloque es demasiado grande).
+*/
+bool beginTransfer(const uint8_t data[], size_t length) {
+    uint8_t count = fragmentCount(length, TRANSFER_FRAGMENT_SIZE);
+    if (transferState != TRANSFER_IDLE || count == 0) {
+        return false;
+    }
+    transferData = data;
+    transferLength = length;
+    transferId++;
+    transferRounds = 0;
+    for (uint8_t i = 0; i < REPORT_FRAGMENT_BITMAP_BYTES; i++) {
+        transferPending[i] = 0;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        transferPending[i / 8] |= 1 << (i % 8);
+    }
+    transferState = TRANSFER_SENDING;
+    return true;
+}
+
+/**
+    endTransfer() se encarga de terminar la transferencia en curso.
+    @param message Motivo (sólo para debug).
+*/
+void endTransfer(const char* message) {
+    transferState = TRANSFER_IDLE;
+    transferData = NULL;
+    #if DEBUG_LEVEL >= 1
+        Serial.print("Transferencia ");
+        Serial.print(transferId);
+        Serial.println(message);
+    #endif
+}
+
+/**
+    transferStatus() se encarga de procesar el mapa de fragmentos faltantes que envía el
+    concentrador: si está vacío, la transferencia terminó; si no, comienza otra ronda
+    con sólo esos fragmentos (hasta TRANSFER_MAX_ROUNDS rondas).
+    @param transfer Identificador de la transferencia.
+    @param missing Mapa de faltantes en hexadecimal (ver readMissingFragments()).
+*/
+void transferStatus(long transfer, const char missing[]) {
+    if (transferState == TRANSFER_IDLE || transfer != transferId) {
+        return;
+    }
+    uint8_t count = fragmentCount(transferLength, TRANSFER_FRAGMENT_SIZE);
+    readMissingFragments(missing, transferPending);
+    bool pending = false;
+    for (uint8_t i = 0; i < REPORT_FRAGMENT_BITMAP_BYTES; i++) {
+        // Descarta los bits de fragmentos inexistentes.
+        if (i * 8 + 8 > count) {
+            transferPending[i] &= (i * 8 < count) ? (1 << (count - i * 8)) - 1 : 0;
+        }
+        pending = pending || transferPending[i] != 0;
+    }
+
+    if (!pending) {
+        endTransfer(" completa!");
+    } else if (++transferRounds > TRANSFER_MAX_ROUNDS) {
+        endTransfer(" abandonada!");
+    } else {
+        transferState = TRANSFER_SENDING;
+    }
+}
+
+/**
+    sendNextFragment() se encarga de transmitir el primer fragmento pendiente.
+    El último fragmento pendiente pide el mapa de faltantes (REPORT_FRAGMENT_POLL).
+*/
+void sendNextFragment() {
+    uint8_t count = fragmentCount(transferLength, TRANSFER_FRAGMENT_SIZE);
+    int index = -1;
+    bool last = true;
+    for (uint8_t i = 0; i < count; i++) {
+        if (transferPending[i / 8] & (1 << (i % 8))) {
+            if (index >= 0) {
+                last = false;
+                break;
+            }
+            index = i;
+        }
+    }
+    if (index < 0) {
+        transferState = TRANSFER_POLLING;
+        return;
+    }
+
+    FragmentHeader header = { DEVICE_ID, transferId, (uint8_t)index, count, TRANSFER_FRAGMENT_SIZE, last };
+    size_t offset = (size_t)index * TRANSFER_FRAGMENT_SIZE;
+    size_t length = min(transferLength - offset, (size_t)TRANSFER_FRAGMENT_SIZE);
+    uint8_t buf[REPORT_FRAGMENT_HEADER_SIZE + TRANSFER_FRAGMENT_SIZE];
+    // Si el ciclo de trabajo no lo permite, se reintenta en el próximo llamado.
+    if (!sendLoRaPacket(buf, encodeFragment(header, transferData + offset, length, buf))) {
+        return;
+    }
+    transferPending[index / 8] &= ~(1 << (index % 8));
+    transferLastIndex = index;
+    if (last) {
+        transferState = TRANSFER_POLLING;
+    }
+}
+
+/**
+    callbackTransfer() se encarga de avanzar la transferencia en curso:
+        - transmite los fragmentos pendientes de a uno, cada vez que la cola de transmisión se vacía,
+        - la espera de TRANSFER_STATUS_TIMEOUT ms del mapa de faltantes comienza cuando
+          se transmitió el fragmento que lo pide,
+        - si vence sin respuesta, vuelve a transmitir ese fragmento (contando una ronda).
+*/
+void callbackTransfer() {
+    switch (transferState) {
+        case TRANSFER_SENDING:
+            if (!LoRa.isTxBusy()) {
+                sendNextFragment();
+            }
+            break;
+        case TRANSFER_POLLING:
+            if (!LoRa.isTxBusy()) {
+                transferDeadline = millis() + TRANSFER_STATUS_TIMEOUT;
+                transferState = TRANSFER_WAITING_STATUS;
+            }
+            break;
+        case TRANSFER_WAITING_STATUS:
+            if ((long)(millis() - transferDeadline) < 0) {
+                break;
+            }
+            if (++transferRounds > TRANSFER_MAX_ROUNDS) {
+                endTransfer(" abandonada!");
+                break;
+            }
+            transferPending[transferLastIndex / 8] |= 1 << (transferLastIndex % 8);
+            transferState = TRANSFER_SENDING;
+            break;
+    }
+}
+#endif
+
+/**
+    transmitCurrentReport() se encarga de componer el reporte del intervalo (binario o de texto)
+    y de transmitirlo (o encolarlo en el lote), junto con la serie de corriente si
+    LORA_SERIES_REPORT está definido. En outcomingReport quedan los valores transmitidos.
+    Si el ciclo de trabajo no permite transmitirlo, el reporte se descarta: el del intervalo
+    siguiente lo reemplaza, ya que contiene el estado completo de los sensores.
+    Si LORA_CONFIRMED_REPORT está definido, el reporte (no así la serie) se transmite
+    como reporte confirmado (ver sendConfirmedReport()).
+*/
+void transmitCurrentReport() {
+    #ifdef LORA_BINARY_REPORT
+        // Compone y serializa el reporte binario (completo o diferencial).
+        outcomingLength = composeBinaryReport(outcomingReport, outcomingBuffer);
+    #else
+        // Compone la carga útil de LoRa.
+        outcomingLength = composeLoRaPayload(currents, raindrops, gas, outcomingBuffer, MAX_SIZE_OUTCOMING_LORA_REPORT);
+        fillReport(outcomingReport);
+    #endif
+
+    // Envía (o encola en el lote) el reporte.
+    #ifdef LORA_CONFIRMED_REPORT
+        bool transmitted = sendConfirmedReport(outcomingBuffer, outcomingLength);
+    #else
+        bool transmitted = transmitReport(outcomingBuffer, outcomingLength);
+    #endif
+
+    #if DEBUG_LEVEL >= 1
+        if (!transmitted) {
+            Serial.println("Reporte LoRa descartado (ciclo de trabajo o cola llena)!");
+        } else {
+            #ifdef LORA_BINARY_REPORT
+                Serial.print("Reporte LoRa encolado! (bytes): ");
+                Serial.println(outcomingLength);
+            #else
+                Serial.print("Payload LoRa encolado!: ");
+                Serial.write(outcomingBuffer, outcomingLength);
+                Serial.println();
+            #endif
+        }
+    #endif
+    #ifdef LORA_EXCEPTION_REPORT
+        reportTransmitted = transmitted;
+    #endif
+    if (!transmitted) {
+        return;
+    }
+    #ifdef LORA_ADR
+        dataRateReportSent();
+    #endif
+
+    #ifdef LORA_SERIES_REPORT
+        // Envía (o encola en el lote) la serie de corriente.
+        outcomingLength = composeSeriesReport(currents, outcomingReport, outcomingBuffer);
+        transmitReport(outcomingBuffer, outcomingLength);
+    #endif
+
+    #ifdef LORA_EXCEPTION_REPORT
+        lastTransmission = millis();
+    #endif
+}
+
+#ifdef LORA_EXCEPTION_REPORT
+/**
+    exceedsDeadband() determina si un valor se alejó del último transmitido más que su banda muerta.
+    Que el valor pase de desconocido a conocido (o viceversa) también la supera.
+    @param value Valor actual.
+    @param last Último valor transmitido.
+    @param deadband Banda muerta (en las unidades del valor).
+    @param unknown Valor que representa "***".
+    @return true si la diferencia supera la banda muerta.
+*/
+bool exceedsDeadband(long value, long last, long deadband, long unknown) {
+    if (value == unknown || last == unknown) {
+        return value != last;
+    }
+    return labs(value - last) > deadband;
+}
+
+/**
+    reportDue() determina si el reporte del intervalo debe transmitirse (modo LORA_EXCEPTION_REPORT):
+        - si el último reporte compuesto no llegó a transmitirse (reportTransmitted == false),
+        - si la corriente, el combustible, la latitud, la longitud o la altitud se alejaron
+          del último reporte transmitido más que su banda muerta (DEADBAND_*),
+        - si cambió el resultado de la votación de lluvia,
+        - si, esperando al próximo intervalo, se superarían EXCEPTION_MAX_SILENCE segundos sin transmitir.
+    @return true si el reporte debe transmitirse.
+*/
+bool reportDue() {
+    if (!reportTransmitted || millis() - lastTransmission + sec2ms(TIMEOUT_LORA) > sec2ms(EXCEPTION_MAX_SILENCE)) {
+        return true;
+    }
+
+    Report current;
+    fillReport(current);
+    const Report& last = outcomingReport;
+    bool due = exceedsDeadband(current.current, last.current, DEADBAND_CURRENT, -1)
+            || current.raindrops != last.raindrops
+            || exceedsDeadband(current.gas, last.gas, DEADBAND_GAS, -1)
+            || exceedsDeadband(current.lat, last.lat, DEADBAND_POSITION, REPORT_UNKNOWN_COORD)
+            || exceedsDeadband(current.lng, last.lng, DEADBAND_POSITION, REPORT_UNKNOWN_COORD)
+            || exceedsDeadband(current.alt, last.alt, DEADBAND_ALTITUDE, REPORT_UNKNOWN_ALT);
+
+    #if DEBUG_LEVEL >= 2
+        if (!due) {
+            Serial.println("Reporte omitido (sin cambios)");
+        }
+    #endif
+    return due;
 }
+#endif
@@ -44,6 +44,34 @@ void callbackLoRaCommand() {
         #endif
         if (incomingPayload == knownCommands[0]) {          // knownCommands[0]: startAlert
             startAlert(750, 10);
+        } else if (incomingPayload.startsWith(knownCommands[1])) {  // knownCommands[1]: ack<seq>[,<snr>]
+            int comma = incomingPayload.indexOf(',');
+            acknowledgeReport(incomingPayload.substring(knownCommands[1].length()).toInt(),
+                              comma < 0 ? ADR_SNR_UNKNOWN : incomingPayload.substring(comma + 1).toInt());
+        } else if (incomingPayload.startsWith(knownCommands[2])) {  // knownCommands[2]: cnf<seq>[,<snr>]
+            #ifdef LORA_CONFIRMED_REPORT
+                int comma = incomingPayload.indexOf(',');
+                confirmReport(incomingPayload.substring(knownCommands[2].length()).toInt(),
+                              comma < 0 ? ADR_SNR_UNKNOWN : incomingPayload.substring(comma + 1).toInt());
+            #endif
+        } else if (incomingPayload.startsWith(knownCommands[3])) {  // knownCommands[3]: frg<transferencia>,<faltantes>
+            #ifdef LORA_TRANSFER
+                int comma = incomingPayload.indexOf(',');
+                if (comma >= 0) {
+                    transferStatus(incomingPayload.substring(knownCommands[3].length()).toInt(),
+                                   incomingPayload.c_str() + comma + 1);
+                }
+            #endif
+        } else if (incomingPayload.startsWith(knownCommands[4])) {  // knownCommands[4]: bcn<época>,<largo de slot>,<cantidad de slots>
+            #ifdef LORA_TDMA
+                int first = incomingPayload.indexOf(',');
+                int second = incomingPayload.indexOf(',', first + 1);
+                if (first >= 0 && second >= 0) {
+                    processBeacon(incomingPayload.substring(knownCommands[4].length(), first).toInt(),
+                                  incomingPayload.substring(first + 1, second).toInt(),
+                                  incomingPayload.substring(second + 1).toInt(), incomingPacket.timestamp);
+                }
+            #endif
         } else {
             #if DEBUG_LEVEL >= 1
                 Serial.println("Descartado por payload incorrecto!");
@@ -0,0 +1,130 @@
+/**
+    Header que contiene la adaptación de la tasa de datos (ADR): a partir de la SNR con que
+    el concentrador recibió los últimos reportes (devuelta en cada "ack<seq>,<snr>"),
+    elige la menor potencia de transmisión que conserva ADR_MARGIN dB de margen sobre la
+    SNR mínima de ADR_SF. Cada ADR_STEP dB de margen sobrante baja ADR_STEP dBm la potencia;
+    cada ADR_STEP dB faltantes la sube.
+    El SF no se adapta: el concentrador es un único SX1278 que escucha en ADR_SF, por lo que
+    un nodo con otro SF dejaría de ser recibido (y de recibir los "ack" que lo harían volver).
+    Para bajar se exigen ADR_HYSTERESIS dB adicionales y ADR_HISTORY SNR medidas con la
+    potencia actual; tras ADR_MAX_MISSED_ACKS reportes sin reconocer, vuelve a ADR_TX_POWER_MAX.
+    Salvo ADR_SNR_UNKNOWN (que usa el comando "ack"), sólo se compila si LORA_ADR está definido.
+    @file adr_helpers.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#define ADR_SNR_UNKNOWN INT16_MIN           // SNR no indicada por el concentrador.
+
+#ifdef LORA_ADR
+/**
+    requiredSnr() obtiene la SNR mínima que demodula el SX1278 con un SF dado
+    (de -7,5 dB con SF7 a -20 dB con SF12, según la hoja de datos).
+    @param sf Factor de ensanchamiento (6 a 12).
+    @return SNR mínima (en décimas de dB).
+*/
+int requiredSnr(int sf) {
+    return -75 - 25 * (sf - 7);
+}
+
+/**
+    applyDataRate() se encarga de configurar la potencia de transmisión elegida
+    en el módulo. Si hay una transmisión en curso, la configuración queda pendiente
+    hasta el próximo llamado (ver sendLoRaPacket()).
+*/
+void applyDataRate() {
+    if (!adrPending || LoRa.isTxBusy()) {
+        return;
+    }
+    // Evita que la interrupción DIO0 acceda al módulo durante la configuración.
+    noInterrupts();
+    LoRa.setTxPower(adrTxPower);
+    interrupts();
+    adrPending = false;
+
+    #if DEBUG_LEVEL >= 1
+        Serial.print("ADR (dBm): ");
+        Serial.println(adrTxPower);
+    #endif
+}
+
+/**
+    setDataRate() se encarga de elegir una potencia de transmisión,
+    descartando las SNR medidas con la potencia anterior.
+    @param txPower Potencia de transmisión (en dBm).
+*/
+void setDataRate(int txPower) {
+    if (txPower != adrTxPower) {
+        adrTxPower = txPower;
+        adrPending = true;
+    }
+    adrSnrCount = 0;
+    adrSnrIndex = 0;
+}
+
+/**
+    adjustDataRate() se encarga de elegir la potencia de transmisión a partir
+    de la mayor de las SNR en adrSnrHistory (que contiene al menos una).
+*/
+void adjustDataRate() {
+    int snr = adrSnrHistory[0];
+    for (int i = 1; i < adrSnrCount; i++) {
+        snr = max(snr, (int)adrSnrHistory[i]);
+    }
+
+    // Margen sobre la SNR mínima del SF (en décimas de dB).
+    int margin = snr * 10 - requiredSnr(ADR_SF) - ADR_MARGIN * 10;
+    int steps;
+    if (margin < 0) {
+        steps = -((-margin + ADR_STEP * 10 - 1) / (ADR_STEP * 10));
+    } else if (margin >= (ADR_STEP + ADR_HYSTERESIS) * 10 && adrSnrCount >= ADR_HISTORY) {
+        steps = (margin - ADR_HYSTERESIS * 10) / (ADR_STEP * 10);
+    } else {
+        return;
+    }
+
+    int txPower = adrTxPower;
+    // Sobra margen: baja la potencia.
+    for (; steps > 0 && txPower - ADR_STEP >= ADR_TX_POWER_MIN; steps--) {
+        txPower -= ADR_STEP;
+    }
+    // Falta margen: sube la potencia.
+    for (; steps < 0 && txPower < ADR_TX_POWER_MAX; steps++) {
+        txPower = min(txPower + ADR_STEP, ADR_TX_POWER_MAX);
+    }
+    setDataRate(txPower);
+}
+
+/**
+    dataRateAcknowledged() se encarga de registrar el reconocimiento del último reporte
+    transmitido, junto con la SNR con que lo recibió el concentrador.
+    @param snr SNR del reporte (en dB), o ADR_SNR_UNKNOWN si el concentrador no la indicó.
+*/
+void dataRateAcknowledged(int snr) {
+    adrAwaitingAck = false;
+    adrMissedAcks = 0;
+    if (snr == ADR_SNR_UNKNOWN) {
+        return;
+    }
+    adrSnrHistory[adrSnrIndex] = constrain(snr, INT8_MIN, INT8_MAX);
+    adrSnrIndex = (adrSnrIndex + 1) % ADR_HISTORY;
+    adrSnrCount = min(adrSnrCount + 1, ADR_HISTORY);
+    adjustDataRate();
+}
+
+/**
+    dataRateReportSent() se encarga de contar los reportes transmitidos sin reconocer:
+    al llegar a ADR_MAX_MISSED_ACKS seguidos, vuelve a la potencia máxima (sin cambiar el SF).
+*/
+void dataRateReportSent() {
+    if (adrAwaitingAck && ++adrMissedAcks >= ADR_MAX_MISSED_ACKS) {
+        #if DEBUG_LEVEL >= 1
+            Serial.println("ADR: sin reconocimientos, potencia máxima");
+        #endif
+        setDataRate(ADR_TX_POWER_MAX);
+        adrMissedAcks = 0;
+    }
+    adrAwaitingAck = true;
+}
+#endif
@@ -0,0 +1,76 @@
+/**
+    Header que contiene el control del ciclo de trabajo: lleva la cuenta del tiempo en el aire
+    (ver LoRa.timeOnAir()) consumido en una ventana móvil de DUTY_CYCLE_WINDOW segundos
+    y determina si una transmisión entra en el presupuesto (DUTY_CYCLE_PERCENT % de la ventana).
+    La ventana se divide en DUTY_CYCLE_BUCKETS subintervalos: al vencer el más viejo, su tiempo
+    deja de contarse, por lo que la ventana efectiva es de entre DUTY_CYCLE_BUCKETS - 1 y
+    DUTY_CYCLE_BUCKETS subintervalos.
+    @file airtime_helpers.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+static_assert(AIRTIME_BUDGET <= UINT16_MAX, "AIRTIME_BUDGET excede un subintervalo de airtimeBuckets");
+
+/**
+    packetAirtime() obtiene el tiempo en el aire de un paquete con la configuración actual del módulo
+    (sin el header si LORA_IMPLICIT_REPORT está definido).
+    @param length Cantidad de bytes del paquete.
+    @return Tiempo en el aire (en ms, redondeado hacia arriba).
+*/
+unsigned long packetAirtime(size_t length) {
+    #ifdef LORA_IMPLICIT_REPORT
+        return (LoRa.timeOnAir(length, true) + 999) / 1000;
+    #else
+        return (LoRa.timeOnAir(length) + 999) / 1000;
+    #endif
+}
+
+/**
+    rotateAirtimeBuckets() se encarga de avanzar la ventana móvil: cada DUTY_CYCLE_WINDOW / DUTY_CYCLE_BUCKETS
+    segundos pasa al subintervalo siguiente, descartando el tiempo en el aire que tenía.
+*/
+void rotateAirtimeBuckets() {
+    const unsigned long bucketLength = sec2ms(DUTY_CYCLE_WINDOW / DUTY_CYCLE_BUCKETS);
+    for (int i = 0; i < DUTY_CYCLE_BUCKETS && millis() - airtimeBucketStart >= bucketLength; i++) {
+        airtimeBucket = (airtimeBucket + 1) % DUTY_CYCLE_BUCKETS;
+        airtimeBuckets[airtimeBucket] = 0;
+        airtimeBucketStart += bucketLength;
+    }
+    // Si pasó más de una ventana completa, la ventana ya quedó vacía.
+    if (millis() - airtimeBucketStart >= bucketLength) {
+        airtimeBucketStart = millis();
+    }
+}
+
+/**
+    consumedAirtime() obtiene el tiempo en el aire consumido en la ventana móvil.
+    @return Tiempo en el aire (en ms).
+*/
+unsigned long consumedAirtime() {
+    rotateAirtimeBuckets();
+    unsigned long total = 0;
+    for (int i = 0; i < DUTY_CYCLE_BUCKETS; i++) {
+        total += airtimeBuckets[i];
+    }
+    return total;
+}
+
+/**
+    dutyCycleAllows() determina si un paquete puede transmitirse sin exceder AIRTIME_BUDGET.
+    @param length Cantidad de bytes del paquete.
+    @return true si el tiempo en el aire del paquete entra en el presupuesto de la ventana.
+*/
+bool dutyCycleAllows(size_t length) {
+    return consumedAirtime() + packetAirtime(length) <= AIRTIME_BUDGET;
+}
+
+/**
+    accountAirtime() se encarga de sumar el tiempo en el aire de un paquete transmitido a la ventana móvil.
+    @param length Cantidad de bytes del paquete.
+*/
+void accountAirtime(size_t length) {
+    rotateAirtimeBuckets();
+    airtimeBuckets[airtimeBucket] += packetAirtime(length);
+}
@@ -0,0 +1,110 @@
+/**
+    Header que contiene funciones para escribir texto en buffers de bytes
+    sin utilizar memoria heap (ni conversiones de float a String).
+    @file buffer_helpers.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+/**
+    writeText() copia una cadena terminada en '\0' dentro de un buffer.
+    Si no hay lugar suficiente, escribe sólo los caracteres que entran.
+    Por ejemplo:
+        uint8_t buf[8];
+        size_t pos = writeText(buf, 0, 8, "lat=");
+    Devuelve 4 (y buf comienza con "lat=").
+    @param buf Buffer de salida.
+    @param pos Posición a partir de la cual escribir.
+    @param maxLen Tamaño total del buffer.
+    @param text Cadena a copiar.
+    @return Posición siguiente al último byte escrito.
+*/
+size_t writeText(uint8_t buf[], size_t pos, size_t maxLen, const char* text) {
+    while (*text != '\0' && pos < maxLen) {
+        buf[pos++] = *text++;
+    }
+    return pos;
+}
+
+/**
+    writeInteger() escribe un entero con signo en base 10 dentro de un buffer.
+    Por ejemplo:
+        size_t pos = writeInteger(buf, 0, 8, -345);
+    Devuelve 4 (y buf comienza con "-345").
+    @param buf Buffer de salida.
+    @param pos Posición a partir de la cual escribir.
+    @param maxLen Tamaño total del buffer.
+    @param value Número a escribir.
+    @return Posición siguiente al último byte escrito.
+*/
+size_t writeInteger(uint8_t buf[], size_t pos, size_t maxLen, long value) {
+    char digits[11];
+    int count = 0;
+    unsigned long magnitude = (value < 0) ? -(unsigned long)value : value;
+
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (value < 0 && pos < maxLen) {
+        buf[pos++] = '-';
+    }
+    while (count > 0 && pos < maxLen) {
+        buf[pos++] = digits[--count];
+    }
+    return pos;
+}
+
+/**
+    writeFixed() escribe un número en punto fijo (un entero escalado por 10^decimals)
+    en base 10 dentro de un buffer, con exactamente decimals posiciones decimales.
+    Por ejemplo:
+        size_t pos = writeFixed(buf, 0, 16, -3457475, 5);
+    Devuelve 9 (y buf comienza con "-34.57475").
+    @param buf Buffer de salida.
+    @param pos Posición a partir de la cual escribir.
+    @param maxLen Tamaño total del buffer.
+    @param value Número escalado a escribir.
+    @param decimals Cantidad de posiciones decimales.
+    @return Posición siguiente al último byte escrito.
+*/
+size_t writeFixed(uint8_t buf[], size_t pos, size_t maxLen, long value, uint8_t decimals) {
+    char digits[11];
+    int count = 0;
+    unsigned long magnitude = (value < 0) ? -(unsigned long)value : value;
+
+    // Se generan al menos decimals + 1 dígitos para que exista la parte entera.
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0 || count <= decimals);
+
+    if (value < 0 && pos < maxLen) {
+        buf[pos++] = '-';
+    }
+    while (count > 0 && pos < maxLen) {
+        if (count == decimals) {
+            buf[pos++] = '.';
+            if (pos == maxLen) {
+                break;
+            }
+        }
+        buf[pos++] = digits[--count];
+    }
+    return pos;
+}
+
+/**
+    decimalScale() obtiene el factor de escala 10^decimals.
+    @param decimals Cantidad de posiciones decimales.
+    @return 10 elevado a decimals.
+*/
+long decimalScale(uint8_t decimals) {
+    long scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    return scale;
+}
@@ -0,0 +1,76 @@
+/**
+    Header que contiene el plan de canales del salto de frecuencia (LORA_FREQUENCY_HOPPING):
+    cada reporte se transmite en un canal de LORA_CHANNEL_PLAN elegido con un hash de
+    (DEVICE_ID, seq), de modo que la carga de los nodos se reparte entre todos los canales
+    y un canal ocupado o con interferencia sólo afecta a una parte de los reportes.
+    Los paquetes de un mismo intervalo (el reporte y su serie, o las retransmisiones de un
+    reporte confirmado) comparten el seq, y por lo tanto el canal.
+    La recepción (comandos, "ack", balizas) sigue siendo en LORA_FREQ, que conviene incluir
+    en el plan como primer canal. El concentrador puede:
+        - escuchar en todos los canales (un receptor por canal), o
+        - con un único receptor, seguir a un nodo: tras decodificar su reporte seq,
+          esperar el siguiente en hopFrequency(deviceId, (uint8_t)(seq + 1)).
+    No depende de Arduino, por lo que también puede incluirse desde el concentrador.
+    @file channel_plan.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef CHANNEL_PLAN_H
+#define CHANNEL_PLAN_H
+
+#include <stdint.h>
+
+/// Plan por defecto: 8 canales de 125 kHz separados 200 kHz, dentro de la banda de 433.05 a 434.79 MHz.
+#ifndef LORA_CHANNEL_PLAN
+    #define LORA_CHANNEL_PLAN { 433175000L, 433375000L, 433575000L, 433775000L, \
+                                433975000L, 434175000L, 434375000L, 434575000L }
+#endif
+
+/**
+    channelPlan contiene las frecuencias (en Hz) del plan de canales.
+*/
+static const long channelPlan[] = LORA_CHANNEL_PLAN;
+
+#define LORA_CHANNELS (sizeof(channelPlan) / sizeof(channelPlan[0]))
+
+/**
+    hopHash() mezcla el identificador del nodo y el seq, para que nodos y seq consecutivos
+    caigan en canales independientes.
+    @param deviceId Identificador del nodo.
+    @param seq Número de secuencia del reporte.
+    @return Hash de 32 bits.
+*/
+inline uint32_t hopHash(uint16_t deviceId, uint16_t seq) {
+    uint32_t x = ((uint32_t)deviceId << 16) | seq;
+    x ^= x >> 16;
+    x *= 0x45d9f3bUL;
+    x ^= x >> 16;
+    x *= 0x45d9f3bUL;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+    hopChannel() obtiene el canal de un reporte.
+    @param deviceId Identificador del nodo.
+    @param seq Número de secuencia del reporte.
+    @return Índice del canal en channelPlan.
+*/
+inline uint8_t hopChannel(uint16_t deviceId, uint16_t seq) {
+    // Reducción por multiplicación: evita la división de 32 bits.
+    return (uint8_t)(((hopHash(deviceId, seq) >> 16) * LORA_CHANNELS) >> 16);
+}
+
+/**
+    hopFrequency() obtiene la frecuencia en que se transmite un reporte.
+    @param deviceId Identificador del nodo.
+    @param seq Número de secuencia del reporte.
+    @return Frecuencia (en Hz).
+*/
+inline long hopFrequency(uint16_t deviceId, uint16_t seq) {
+    return channelPlan[hopChannel(deviceId, seq)];
+}
+
+#endif
@@ -18,10 +18,57 @@
 #define DEVICE_ID_MAX_SIZE 6           // Tamaño máximo que se espera para cada DEVICE_ID entrante.
 #define INCOMING_PAYLOAD_MAX_SIZE 50   // Tamaño máximo esperado del payload LoRa entrante.
 #define INCOMING_FULL_MAX_SIZE (INCOMING_PAYLOAD_MAX_SIZE + DEVICE_ID_MAX_SIZE + 2) // Tamaño máximo esperado del mensaje entrante.
-#define MAX_SIZE_OUTCOMING_LORA_REPORT 200      // Tamaño máximo esperado del payload LoRa saliente.
-#define KNOWN_COMMANDS_SIZE 1       // Cantidad de comandos LoRa conocidos.
+#define MAX_SIZE_OUTCOMING_LORA_REPORT LORA_TX_MAX_PACKET  // Tamaño del buffer del payload LoRa saliente (el mayor paquete que entra en la cola de transmisión).
+#define KNOWN_COMMANDS_SIZE 5       // Cantidad de comandos LoRa conocidos.
 #define TIMEOUT_LORA 20			    // Tiempo entre cada mensaje LoRa.
 #define LORA_SYNC_WORD 0x34			// Palabra de sincronización LoRa.
+#define LORA_IMPLICIT_SYNC_WORD 0x35    // Palabra de sincronización del perfil de header implícito (ver LORA_IMPLICIT_REPORT).
+#define LORA_BINARY_REPORT          // Transmite el reporte binario (ver report_helpers.h) en lugar del de texto.
+#define LORA_DELTA_REPORT           // Transmite reportes diferenciales respecto del último reconocido (requiere LORA_BINARY_REPORT).
+#define LORA_PACKED_REPORT          // Los reportes completos se empaquetan a nivel de bits (ver report_fields.h).
+#define DELTA_KEYFRAME_INTERVAL 15  // Cantidad máxima de reportes diferenciales entre dos reportes completos.
+// #define LORA_IMPLICIT_REPORT     // Transmite los reportes completos con header implícito y largo fijo (no admite LORA_DELTA_REPORT, LORA_SERIES_REPORT ni LORA_BATCH_REPORT).
+// #define LORA_SERIES_REPORT       // Transmite además la serie de corriente completa (ver report_series.h).
+#define SERIES_BITS 12              // Bits por muestra de la serie de corriente (8 ó 12).
+// #define LORA_BATCH_REPORT        // Agrupa los reportes de varios intervalos en un único paquete.
+#define LORA_BATCH_SIZE 6           // Cantidad máxima de registros por lote (con LORA_SERIES_REPORT, 2 por intervalo).
+#define BATCH_MAX_DELAY 120         // Máxima antigüedad (en segundos) del registro más viejo de un lote al transmitirlo.
+// #define LORA_CONFIRMED_REPORT    // Pide confirmación de cada reporte y lo retransmite si no llega (requiere LORA_BINARY_REPORT, no admite LORA_BATCH_REPORT).
+#define CONFIRMED_RX_WINDOW 1500    // Tiempo (en ms) que se espera la confirmación, desde que termina la transmisión.
+#define CONFIRMED_MAX_RETRIES 3     // Cantidad máxima de retransmisiones de un reporte confirmado.
+#define CONFIRMED_BACKOFF 1000      // Espera base (en ms) antes de retransmitir, se duplica en cada retransmisión.
+#define CONFIRMED_MAX_SIZE (REPORT_CONFIRMED_HEADER_SIZE + REPORT_DELTA_MAX_SIZE)    // Tamaño del buffer del reporte confirmado.
+// #define LORA_TRANSFER            // Habilita las transferencias fragmentadas de bloques mayores que un paquete (ver beginTransfer()).
+#define TRANSFER_FRAGMENT_SIZE 48   // Bytes de datos por fragmento de una transferencia (ver report_fragments.h).
+#define TRANSFER_STATUS_TIMEOUT 3000    // Tiempo (en ms) que se espera el mapa de faltantes, desde que termina la transmisión.
+#define TRANSFER_MAX_ROUNDS 5       // Cantidad máxima de rondas de retransmisión de una transferencia.
+// #define LORA_EXCEPTION_REPORT    // Sólo transmite si algún campo supera su banda muerta o vence EXCEPTION_MAX_SILENCE.
+#define EXCEPTION_MAX_SILENCE 600   // Máximo tiempo (en segundos) sin transmitir un reporte.
+#define DEADBAND_CURRENT 20         // Banda muerta de la corriente (en cA).
+#define DEADBAND_GAS 20             // Banda muerta del combustible (en dL).
+#define DEADBAND_POSITION 5000      // Banda muerta de la latitud y la longitud (en 1e-7 grados, unos 55 m).
+#define DEADBAND_ALTITUDE 20        // Banda muerta de la altitud (en m).
+#define DUTY_CYCLE_PERCENT 1        // Ciclo de trabajo máximo de la banda (en %).
+#define DUTY_CYCLE_WINDOW 3600      // Ventana móvil sobre la que se mide el ciclo de trabajo (en segundos).
+#define DUTY_CYCLE_BUCKETS 12       // Cantidad de subintervalos de la ventana móvil (ver airtime_helpers.h).
+#define AIRTIME_BUDGET (DUTY_CYCLE_WINDOW * 10UL * DUTY_CYCLE_PERCENT) // Tiempo en el aire disponible por ventana (en ms).
+// #define LORA_TDMA                // Transmite los reportes en el slot de este nodo según la baliza del concentrador (ver tdma_helpers.h).
+#define TDMA_GUARD 20               // Margen (en ms) al comienzo y al final de cada slot.
+#define TDMA_BEACON_TIMEOUT 600     // Tiempo (en segundos) sin baliza tras el cual vuelve a transmitir cada TIMEOUT_LORA segundos.
+#define LORA_LISTEN_BEFORE_TALK     // Escucha el canal (CAD) antes de transmitir y espera un tiempo aleatorio si está ocupado.
+// #define LORA_FREQUENCY_HOPPING   // Transmite cada reporte en un canal de LORA_CHANNEL_PLAN elegido según (DEVICE_ID, seq) (ver channel_plan.h, requiere LORA_BINARY_REPORT).
+// #define LORA_RX_WINDOWS          // Duerme la radio y sólo recibe en ventanas: tras cada transmisión y cada LORA_PING_PERIOD segundos (requiere DIO1_PIN).
+#define LORA_RX_WINDOW 1500         // Duración (en ms) de cada ventana de recepción (al menos CONFIRMED_RX_WINDOW y, con LORA_TRANSFER, TRANSFER_STATUS_TIMEOUT; se verifica al compilar).
+#define LORA_PING_PERIOD 0          // Tiempo (en segundos) entre ventanas de recepción periódicas, para comandos y balizas (0: sólo tras transmitir).
+// #define LORA_ADR                 // Adapta la potencia a la SNR que devuelve el concentrador en cada "ack" (ver adr_helpers.h, requiere LORA_BINARY_REPORT).
+#define ADR_SF 7                    // SF de nodos y concentrador (el de la biblioteca); el ADR no lo cambia.
+#define ADR_TX_POWER_MIN 2          // Menor potencia de transmisión (en dBm).
+#define ADR_TX_POWER_MAX 17         // Mayor potencia de transmisión (en dBm).
+#define ADR_MARGIN 10               // Margen (en dB) a conservar sobre la SNR mínima de ADR_SF.
+#define ADR_STEP 3                  // Paso (en dB) de cada ajuste de potencia.
+#define ADR_HYSTERESIS 3            // Margen adicional (en dB) exigido para bajar la potencia.
+#define ADR_HISTORY 8               // Cantidad de SNR recientes consideradas (se toma la mayor).
+#define ADR_MAX_MISSED_ACKS 4       // Reportes seguidos sin reconocer antes de volver a la potencia máxima.
 
 /// Arrays.
 #define SENSORS_QTY 2               // Cantidad de sensores conectados.
@@ -39,6 +86,13 @@
 #define EMON_TIMEOUT 1000           // timeout de la rutina calcVI (en ms).
 #define GPS_DECIMAL_POSITIONS 5     // Cantidad de posiciones decimales para medir la longitud y latitud del GPS.
 
+/// Campos del reporte empaquetado (false los descarta del paquete, ver report_fields.h).
+#define REPORT_FIELD_CURRENT_ENABLED true
+#define REPORT_FIELD_RAINDROPS_ENABLED true
+#define REPORT_FIELD_GAS_ENABLED true
+#define REPORT_FIELD_GPS_ENABLED true
+#define REPORT_FIELD_AIRTIME_ENABLED true
+
 /// Valores mock.
 // #define CORRIENTE_MOCK 0.26        // Corriente falsa.
 // #define RAINDROP_MOCK 0            // Lluvia falsa.
@@ -19,3 +19,32 @@ float round2decimals(float var) {
     float value = (int)(var * 100 + 0.5);
     return (float)(value / 100);
 }
+
+/**
+    scaleRound() escala una variable de tipo float y la redondea al entero más cercano,
+    saturando dentro del rango [minValue, maxValue]. Un NaN (por ejemplo, el promedio
+    de un array sin mediciones) devuelve 0.
+    Por ejemplo:
+        float var = 123.5187;
+        long gasDl = scaleRound(var, 10, 0, 65535);
+    Devuelve 1235.
+    @param var Número a escalar.
+    @param scale Factor de escala.
+    @param minValue Mínimo valor admitido.
+    @param maxValue Máximo valor admitido.
+    @return Número escalado, redondeado y saturado.
+*/
+long scaleRound(float var, long scale, long minValue, long maxValue) {
+    if (var != var) {
+        return 0;
+    }
+    float value = var * scale;
+    value += (value < 0) ? -0.5 : 0.5;
+    if (value <= minValue) {
+        return minValue;
+    }
+    if (value >= maxValue) {
+        return maxValue;
+    }
+    return (long)value;
+}
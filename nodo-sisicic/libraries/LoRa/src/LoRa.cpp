@@ -23,6 +23,7 @@
 #define REG_RSSI_VALUE           0x1b
 #define REG_MODEM_CONFIG_1       0x1d
 #define REG_MODEM_CONFIG_2       0x1e
+#define REG_SYMB_TIMEOUT_LSB     0x1f
 #define REG_PREAMBLE_MSB         0x20
 #define REG_PREAMBLE_LSB         0x21
 #define REG_PAYLOAD_LENGTH       0x22
@@ -47,21 +48,23 @@
 #define MODE_TX                  0x03
 #define MODE_RX_CONTINUOUS       0x05
 #define MODE_RX_SINGLE           0x06
+#define MODE_CAD                 0x07
 
 // PA config
 #define PA_BOOST                 0x80
 
 // IRQ masks
+#define IRQ_CAD_DETECTED_MASK      0x01
+#define IRQ_CAD_DONE_MASK          0x04
 #define IRQ_TX_DONE_MASK           0x08
 #define IRQ_PAYLOAD_CRC_ERROR_MASK 0x20
 #define IRQ_RX_DONE_MASK           0x40
+#define IRQ_RX_TIMEOUT_MASK        0x80
 
 #define RF_MID_BAND_THRESHOLD    525E6
 #define RSSI_OFFSET_HF_PORT      157
 #define RSSI_OFFSET_LF_PORT      164
 
-#define MAX_PKT_LENGTH           255
-
 #if (ESP8266 || ESP32)
     #define ISR_PREFIX ICACHE_RAM_ATTR
 #else
@@ -71,15 +74,40 @@
 LoRaClass::LoRaClass() :
   _spiSettings(LORA_DEFAULT_SPI_FREQUENCY, MSBFIRST, SPI_MODE0),
   _spi(&LORA_DEFAULT_SPI),
-  _ss(LORA_DEFAULT_SS_PIN), _reset(LORA_DEFAULT_RESET_PIN), _dio0(LORA_DEFAULT_DIO0_PIN),
+  _ss(LORA_DEFAULT_SS_PIN), _reset(LORA_DEFAULT_RESET_PIN), _dio0(LORA_DEFAULT_DIO0_PIN), _dio1(-1),
   _frequency(0),
+  _frf(0),
   _packetIndex(0),
+  _payloadLength(0),
   _implicitHeaderMode(0),
   _onReceive(NULL),
-  _onTxDone(NULL)
+  _onTxDone(NULL),
+  _rxQueueEnabled(false),
+  _rxHead(0),
+  _rxTail(0),
+  _rxDropped(0),
+  _receiveSize(0),
+  _txHead(0),
+  _txTail(0),
+  _txBusy(false),
+  _txBackoff(false),
+  _txSize(0),
+  _txSlot(0),
+  _txImplicit(false),
+  _txHopped(false),
+  _txRetryAt(0),
+  _lbtEnabled(false),
+  _lbtAttempts(0),
+  _channelBusyCount(0),
+  _rxWindowLength(0),
+  _rxWindowOpen(false),
+  _rxWindowStart(0),
+  _spiTransactions(0)
 {
   // overide Stream timeout value
   setTimeout(0);
+
+  invalidateShadow();
 }
 
 int LoRaClass::begin(long frequency)
@@ -101,6 +129,9 @@ int LoRaClass::begin(long frequency)
   delay(50);
 #endif
 
+  // the registers go back to their defaults on reset, forget the shadow copy
+  invalidateShadow();
+
   // setup pins
   pinMode(_ss, OUTPUT);
   // set SS high
@@ -157,6 +188,8 @@ void LoRaClass::end()
 
   // stop SPI
   _spi->end();
+
+  invalidateShadow();
 }
 
 int LoRaClass::beginPacket(int implicitHeader)
@@ -177,13 +210,16 @@ int LoRaClass::beginPacket(int implicitHeader)
   // reset FIFO address and paload length
   writeRegister(REG_FIFO_ADDR_PTR, 0);
   writeRegister(REG_PAYLOAD_LENGTH, 0);
+  _payloadLength = 0;
 
   return 1;
 }
 
 int LoRaClass::endPacket(bool async)
 {
-  
+  // the length is cached by write(), set it once before transmitting
+  writeRegister(REG_PAYLOAD_LENGTH, _payloadLength);
+
   if ((async) && (_onTxDone))
       writeRegister(REG_DIO_MAPPING_1, 0x40); // DIO0 => TXDONE
 
@@ -302,20 +338,14 @@ size_t LoRaClass::write(uint8_t byte)
 
 size_t LoRaClass::write(const uint8_t *buffer, size_t size)
 {
-  int currentLength = readRegister(REG_PAYLOAD_LENGTH);
-
   // check size
-  if ((currentLength + size) > MAX_PKT_LENGTH) {
-    size = MAX_PKT_LENGTH - currentLength;
-  }
-
-  // write data
-  for (size_t i = 0; i < size; i++) {
-    writeRegister(REG_FIFO, buffer[i]);
+  if ((_payloadLength + size) > MAX_PKT_LENGTH) {
+    size = MAX_PKT_LENGTH - _payloadLength;
   }
 
-  // update length
-  writeRegister(REG_PAYLOAD_LENGTH, currentLength + size);
+  // write data in a single SPI transaction, REG_PAYLOAD_LENGTH is written by endPacket()
+  burstWrite(REG_FIFO, buffer, size);
+  _payloadLength += size;
 
   return size;
 }
@@ -358,6 +388,24 @@ void LoRaClass::flush()
 {
 }
 
+size_t LoRaClass::readBytes(uint8_t *buffer, size_t length)
+{
+  int remaining = available();
+
+  if (remaining <= 0) {
+    return 0;
+  }
+  if (length > (size_t)remaining) {
+    length = remaining;
+  }
+
+  // read data in a single SPI transaction
+  burstRead(REG_FIFO, buffer, length);
+  _packetIndex += length;
+
+  return length;
+}
+
 #ifndef ARDUINO_SAMD_MKRWAN1300
 void LoRaClass::onReceive(void(*callback)(int))
 {
@@ -395,8 +443,243 @@ void LoRaClass::onTxDone(void(*callback)())
   }
 }
 
+void LoRaClass::enableReceiveQueue()
+{
+  _rxQueueEnabled = true;
+
+  pinMode(_dio0, INPUT);
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+  SPI.usingInterrupt(digitalPinToInterrupt(_dio0));
+#endif
+  attachInterrupt(digitalPinToInterrupt(_dio0), LoRaClass::onDio0Rise, RISING);
+}
+
+void LoRaClass::disableReceiveQueue()
+{
+  _rxQueueEnabled = false;
+
+  if (!_onReceive && !_onTxDone) {
+    detachInterrupt(digitalPinToInterrupt(_dio0));
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+    SPI.notUsingInterrupt(digitalPinToInterrupt(_dio0));
+#endif
+  }
+}
+
+bool LoRaClass::popPacket(LoRaPacket& packet)
+{
+  uint8_t tail = _rxTail;
+
+  if (tail == _rxHead) {
+    return false;
+  }
+
+  // the ISR never writes the tail slot, so it can be copied without disabling interrupts
+  packet = _rxQueue[tail];
+  _rxTail = (tail + 1) & (LORA_RX_QUEUE_SLOTS - 1);
+
+  return true;
+}
+
+bool LoRaClass::enqueuePacket(const uint8_t *buffer, size_t size, bool implicitHeader, long frequency)
+{
+  if (size == 0 || size > LORA_TX_MAX_PACKET) {
+    return false;
+  }
+
+  // the FRF value and the backoff slot (one packet airtime, in ms) are computed here,
+  // out of the ISRs that load the packet and back it off
+  uint32_t frf = frequency > 0 ? ((uint64_t)frequency << 19) / 32000000 : 0;
+  unsigned long slot = timeOnAir(size, implicitHeader) / 1000 + 1;
+  if (slot > 0xffff) {
+    slot = 0xffff;
+  }
+
+  noInterrupts();
+  uint16_t head = _txHead;
+  interrupts();
+
+  // head and tail run freely, their difference is the number of queued bytes, and each entry
+  // is its size, the implicit header flag, the FRF (0 keeps the receive frequency) and the backoff slot
+  uint16_t tail = _txTail;
+  if ((uint16_t)(tail - head) + LORA_TX_ENTRY_HEADER + size > LORA_TX_QUEUE_SIZE) {
+    return false;
+  }
+
+  // the ISR only reads up to the published tail, so the copy can run with interrupts enabled
+  _txQueue[tail++ & (LORA_TX_QUEUE_SIZE - 1)] = size;
+  _txQueue[tail++ & (LORA_TX_QUEUE_SIZE - 1)] = implicitHeader;
+  _txQueue[tail++ & (LORA_TX_QUEUE_SIZE - 1)] = frf >> 16;
+  _txQueue[tail++ & (LORA_TX_QUEUE_SIZE - 1)] = frf >> 8;
+  _txQueue[tail++ & (LORA_TX_QUEUE_SIZE - 1)] = frf;
+  _txQueue[tail++ & (LORA_TX_QUEUE_SIZE - 1)] = slot >> 8;
+  _txQueue[tail++ & (LORA_TX_QUEUE_SIZE - 1)] = slot;
+  for (size_t i = 0; i < size; i++) {
+    _txQueue[tail++ & (LORA_TX_QUEUE_SIZE - 1)] = buffer[i];
+  }
+
+  noInterrupts();
+  _txTail = tail;
+  bool start = !_txBusy;
+  _txBusy = true;
+  interrupts();
+
+  if (start) {
+    pinMode(_dio0, INPUT);
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+    SPI.usingInterrupt(digitalPinToInterrupt(_dio0));
+#endif
+    attachInterrupt(digitalPinToInterrupt(_dio0), LoRaClass::onDio0Rise, RISING);
+
+    // keep the DIO0 handler from using the FIFO while it is loaded
+    noInterrupts();
+    transmitQueued();
+    interrupts();
+  }
+
+  return true;
+}
+
+void LoRaClass::transmitQueued()
+{
+  uint16_t head = _txHead;
+  uint8_t size = _txQueue[head++ & (LORA_TX_QUEUE_SIZE - 1)];
+  _txImplicit = _txQueue[head++ & (LORA_TX_QUEUE_SIZE - 1)];
+  uint32_t frf = (uint32_t)_txQueue[head++ & (LORA_TX_QUEUE_SIZE - 1)] << 16;
+  frf |= (uint32_t)_txQueue[head++ & (LORA_TX_QUEUE_SIZE - 1)] << 8;
+  frf |= _txQueue[head++ & (LORA_TX_QUEUE_SIZE - 1)];
+  _txSlot = (uint16_t)_txQueue[head++ & (LORA_TX_QUEUE_SIZE - 1)] << 8;
+  _txSlot |= _txQueue[head++ & (LORA_TX_QUEUE_SIZE - 1)];
+  _txSize = size;
+
+  // receive() restores the header mode and the frequency of the receiver once the queue is empty,
+  // and the transmission ends the current receive window (TxDone opens a new one)
+  idle();
+  _rxWindowOpen = false;
+  if (frf != 0) {
+    writeFrequency(frf);
+    _txHopped = true;
+  } else if (_txHopped) {
+    writeFrequency(_frf);
+    _txHopped = false;
+  }
+  if (_txImplicit) {
+    implicitHeaderMode();
+  } else {
+    explicitHeaderMode();
+  }
+  writeRegister(REG_FIFO_ADDR_PTR, 0);
+  _payloadLength = 0;
+
+  // the packet may wrap around the end of the queue
+  uint16_t offset = head & (LORA_TX_QUEUE_SIZE - 1);
+  size_t first = LORA_TX_QUEUE_SIZE - offset;
+  if (first > size) {
+    first = size;
+  }
+  write(_txQueue + offset, first);
+  write(_txQueue, size - first);
+
+  if (_lbtEnabled && _lbtAttempts < LORA_LBT_MAX_ATTEMPTS) {
+    // listen before talk, the CadDone interrupt decides (the FIFO is kept in CAD mode)
+    writeRegister(REG_DIO_MAPPING_1, 0x80); // DIO0 => CADDONE
+    writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_CAD);
+  } else {
+    startQueued();
+  }
+}
+
+void LoRaClass::startQueued()
+{
+  // the packet leaves the queue once it is on the air
+  _txHead += LORA_TX_ENTRY_HEADER + _txSize;
+  _lbtAttempts = 0;
+
+  writeRegister(REG_DIO_MAPPING_1, 0x40); // DIO0 => TXDONE
+  endPacket(true);
+}
+
+void LoRaClass::backoffQueued()
+{
+  _lbtAttempts++;
+  _channelBusyCount++;
+
+  // listen while waiting (sleep with receive windows), the packet is loaded again by poll()
+  if (_rxWindowLength > 0) {
+    sleep();
+  } else {
+    receive(_receiveSize);
+  }
+
+  // wait 1 to 2^(attempts + 1) slots of one packet airtime each (see enqueuePacket())
+  uint8_t window = 2 << _lbtAttempts;
+  _txRetryAt = millis() + (1 + random() % window) * (unsigned long)_txSlot;
+  _txBackoff = true;
+}
+
+void LoRaClass::enableListenBeforeTalk()
+{
+  _lbtEnabled = true;
+}
+
+void LoRaClass::disableListenBeforeTalk()
+{
+  _lbtEnabled = false;
+}
+
+void LoRaClass::poll()
+{
+  // without DIO1 (or if a packet never completed) the window is closed here
+  if (_rxWindowOpen && millis() - _rxWindowStart >= _rxWindowLength + LORA_RX_WINDOW_GRACE) {
+    noInterrupts();
+    if (_rxWindowOpen) {
+      closeWindow();
+    }
+    interrupts();
+  }
+
+  if (!_txBackoff || (long)(millis() - _txRetryAt) < 0) {
+    return;
+  }
+
+  // keep the DIO0 handler from using the FIFO while it is loaded
+  noInterrupts();
+  _txBackoff = false;
+  transmitQueued();
+  interrupts();
+}
+
+bool LoRaClass::isChannelBusy()
+{
+  if (_txBusy) {
+    return true;
+  }
+
+  idle();
+
+  // DIO0 stays on RXDONE, so the CAD is not seen by the DIO0 handler
+  writeRegister(REG_DIO_MAPPING_1, 0x00);
+  writeRegister(REG_IRQ_FLAGS, IRQ_CAD_DONE_MASK | IRQ_CAD_DETECTED_MASK);
+  writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_CAD);
+
+  // wait for CAD done
+  int irqFlags;
+  while (((irqFlags = readRegister(REG_IRQ_FLAGS)) & IRQ_CAD_DONE_MASK) == 0) {
+    yield();
+  }
+
+  // clear IRQ's
+  writeRegister(REG_IRQ_FLAGS, IRQ_CAD_DONE_MASK | IRQ_CAD_DETECTED_MASK);
+
+  return (irqFlags & IRQ_CAD_DETECTED_MASK) != 0;
+}
+
 void LoRaClass::receive(int size)
 {
+  _receiveSize = size;
+  _rxWindowOpen = false;
+
+  restoreFrequency();
 
   writeRegister(REG_DIO_MAPPING_1, 0x00); // DIO0 => RXDONE
 
@@ -412,6 +695,121 @@ void LoRaClass::receive(int size)
 }
 #endif
 
+void LoRaClass::enableReceiveWindows(unsigned long length)
+{
+  _rxWindowLength = length;
+
+  pinMode(_dio0, INPUT);
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+  SPI.usingInterrupt(digitalPinToInterrupt(_dio0));
+#endif
+  attachInterrupt(digitalPinToInterrupt(_dio0), LoRaClass::onDio0Rise, RISING);
+
+  if (_dio1 >= 0) {
+    pinMode(_dio1, INPUT);
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+    SPI.usingInterrupt(digitalPinToInterrupt(_dio1));
+#endif
+    attachInterrupt(digitalPinToInterrupt(_dio1), LoRaClass::onDio1Rise, RISING);
+  }
+
+  // sleep until the next window, a transmission in progress opens one when the queue is empty
+  noInterrupts();
+  if (!_txBusy) {
+    closeWindow();
+  }
+  interrupts();
+}
+
+void LoRaClass::disableReceiveWindows()
+{
+  _rxWindowLength = 0;
+
+  if (_dio1 >= 0) {
+    detachInterrupt(digitalPinToInterrupt(_dio1));
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+    SPI.notUsingInterrupt(digitalPinToInterrupt(_dio1));
+#endif
+  }
+
+  // back to continuous receive, once the queue is empty if it is transmitting
+  noInterrupts();
+  _rxWindowOpen = false;
+  if (!_txBusy) {
+    receive(_receiveSize);
+  }
+  interrupts();
+}
+
+void LoRaClass::receiveWindow()
+{
+  noInterrupts();
+  if (_rxWindowLength > 0 && !_txBusy) {
+    listen();
+  }
+  interrupts();
+}
+
+void LoRaClass::listen()
+{
+  if (_rxWindowLength == 0) {
+    receive(_receiveSize);
+    return;
+  }
+
+  _rxWindowOpen = true;
+  _rxWindowStart = millis();
+  continueWindow();
+}
+
+void LoRaClass::continueWindow()
+{
+  unsigned long elapsed = millis() - _rxWindowStart;
+  long bw = getSignalBandwidth();
+
+  if (elapsed >= _rxWindowLength || bw <= 0) {
+    closeWindow();
+    return;
+  }
+
+  // RX single stops looking for a preamble after at most 1023 symbols, longer windows chain several
+  unsigned long symbolDuration = ((1UL << getSpreadingFactor()) * 1000000UL) / bw; // in us
+  unsigned long symbols = (_rxWindowLength - elapsed) * 1000UL / symbolDuration + 1;
+  if (symbols > 1023) {
+    symbols = 1023;
+  } else if (symbols < 4) {
+    symbols = 4;
+  }
+
+  restoreFrequency();
+  if (_receiveSize > 0) {
+    implicitHeaderMode();
+
+    writeRegister(REG_PAYLOAD_LENGTH, _receiveSize & 0xff);
+  } else {
+    explicitHeaderMode();
+  }
+
+  writeRegister(REG_DIO_MAPPING_1, 0x00); // DIO0 => RXDONE, DIO1 => RXTIMEOUT
+  writeRegister(REG_MODEM_CONFIG_2, (readRegister(REG_MODEM_CONFIG_2) & 0xfc) | (symbols >> 8));
+  writeRegister(REG_SYMB_TIMEOUT_LSB, symbols & 0xff);
+  writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_SINGLE);
+}
+
+void LoRaClass::closeWindow()
+{
+  _rxWindowOpen = false;
+  sleep();
+}
+
+void LoRaClass::restoreFrequency()
+{
+  if (_txHopped) {
+    writeFrequency(_frf);
+    _txHopped = false;
+  }
+}
+
 void LoRaClass::idle()
 {
   writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_STDBY);
@@ -462,12 +860,20 @@ void LoRaClass::setTxPower(int level, int outputPin)
 void LoRaClass::setFrequency(long frequency)
 {
   _frequency = frequency;
+  _frf = ((uint64_t)frequency << 19) / 32000000;
+  _txHopped = false;
 
-  uint64_t frf = ((uint64_t)frequency << 19) / 32000000;
+  writeFrequency(_frf);
+}
 
-  writeRegister(REG_FRF_MSB, (uint8_t)(frf >> 16));
-  writeRegister(REG_FRF_MID, (uint8_t)(frf >> 8));
-  writeRegister(REG_FRF_LSB, (uint8_t)(frf >> 0));
+void LoRaClass::writeFrequency(uint32_t frf)
+{
+  // REG_FRF_MSB, REG_FRF_MID and REG_FRF_LSB are consecutive
+  uint8_t value[3] = { (uint8_t)(frf >> 16), (uint8_t)(frf >> 8), (uint8_t)(frf >> 0) };
+  burstWrite(REG_FRF_MSB, value, sizeof(value));
+  for (uint8_t i = 0; i < sizeof(value); i++) {
+    updateShadow(REG_FRF_MSB + i, value[i]);
+  }
 }
 
 int LoRaClass::getSpreadingFactor()
@@ -558,6 +964,32 @@ void LoRaClass::setLdoFlag()
   writeRegister(REG_MODEM_CONFIG_3, config3);
 }
 
+unsigned long LoRaClass::timeOnAir(int size, int implicitHeader)
+{
+  // Section 4.1.1.7, with the current modem configuration
+  int sf = getSpreadingFactor();
+  long bw = getSignalBandwidth();
+  int cr = (readRegister(REG_MODEM_CONFIG_1) >> 1) & 0x07;
+  bool crc = readRegister(REG_MODEM_CONFIG_2) & 0x04;
+  bool ldo = readRegister(REG_MODEM_CONFIG_3) & 0x08;
+  long preamble = ((long)readRegister(REG_PREAMBLE_MSB) << 8) | readRegister(REG_PREAMBLE_LSB);
+
+  if (bw <= 0) {
+    return 0;
+  }
+
+  float symbolDuration = (float)(1L << sf) * 1E6 / bw; // in us
+
+  long numerator = 8L * size - 4L * sf + 28 + (crc ? 16 : 0) - (implicitHeader ? 20 : 0);
+  long denominator = 4L * (sf - (ldo ? 2 : 0));
+  long payloadSymbols = 8;
+  if (numerator > 0) {
+    payloadSymbols += ((numerator + denominator - 1) / denominator) * (cr + 4);
+  }
+
+  return (unsigned long)((preamble + 4.25f + payloadSymbols) * symbolDuration + 0.5f);
+}
+
 void LoRaClass::setCodingRate4(int denominator)
 {
   if (denominator < 5) {
@@ -648,11 +1080,12 @@ byte LoRaClass::random()
   return readRegister(REG_RSSI_WIDEBAND);
 }
 
-void LoRaClass::setPins(int ss, int reset, int dio0)
+void LoRaClass::setPins(int ss, int reset, int dio0, int dio1)
 {
   _ss = ss;
   _reset = reset;
   _dio0 = dio0;
+  _dio1 = dio1;
 }
 
 void LoRaClass::setSPI(SPIClass& spi)
@@ -671,7 +1104,8 @@ void LoRaClass::dumpRegisters(Stream& out)
     out.print("0x");
     out.print(i, HEX);
     out.print(": 0x");
-    out.println(readRegister(i), HEX);
+    // bypass the shadow copy, to show what the radio really holds
+    out.println(singleTransfer(i & 0x7f, 0x00), HEX);
   }
 }
 
@@ -708,26 +1142,186 @@ void LoRaClass::handleDio0Rise()
       // set FIFO address to current RX address
       writeRegister(REG_FIFO_ADDR_PTR, readRegister(REG_FIFO_RX_CURRENT_ADDR));
 
-      if (_onReceive) {
+      if (_rxQueueEnabled) {
+        queuePacket(packetLength);
+      } else if (_onReceive) {
         _onReceive(packetLength);
       }
     }
     else if ((irqFlags & IRQ_TX_DONE_MASK) != 0) {
+      if (_txBusy) {
+        // start the next queued packet, or go back to continuous receive (or a receive window)
+        if (_txHead != _txTail) {
+          transmitQueued();
+        } else {
+          _txBusy = false;
+          listen();
+        }
+      }
       if (_onTxDone) {
         _onTxDone();
       }
     }
+    else if ((irqFlags & IRQ_CAD_DONE_MASK) != 0) {
+      if (_txBusy) {
+        // transmit on a free channel, back off on a busy one
+        if ((irqFlags & IRQ_CAD_DETECTED_MASK) == 0) {
+          startQueued();
+        } else {
+          backoffQueued();
+        }
+      }
+    }
+  }
+
+  // RX single ends in standby after each packet (even a corrupted one), keep listening until the window ends
+  if (_rxWindowOpen && (irqFlags & IRQ_RX_DONE_MASK) != 0) {
+    continueWindow();
+  }
+}
+
+void LoRaClass::handleDio1Rise()
+{
+  int irqFlags = readRegister(REG_IRQ_FLAGS);
+
+  // clear only RxTimeout, RxDone belongs to DIO0
+  writeRegister(REG_IRQ_FLAGS, irqFlags & IRQ_RX_TIMEOUT_MASK);
+
+  if (_rxWindowOpen && (irqFlags & IRQ_RX_TIMEOUT_MASK) != 0) {
+    continueWindow();
+  }
+}
+
+void LoRaClass::queuePacket(int packetLength)
+{
+  uint8_t head = _rxHead;
+  uint8_t next = (head + 1) & (LORA_RX_QUEUE_SLOTS - 1);
+
+  // drop the packet if the queue is full or it does not fit in a slot
+  if (next == _rxTail || packetLength > LORA_RX_SLOT_SIZE) {
+    _rxDropped++;
+    return;
   }
+
+  LoRaPacket& slot = _rxQueue[head];
+  slot.length = readBytes(slot.data, packetLength);
+  slot.rssi = packetRssi();
+  slot.snr = packetSnr();
+  slot.timestamp = micros();
+
+  // publish the slot only once it is complete
+  _rxHead = next;
+}
+
+void LoRaClass::invalidateShadow()
+{
+  for (int i = 0; i < LORA_SHADOW_REGISTERS; i++) {
+    _shadowValid[i] = false;
+  }
+}
+
+int LoRaClass::shadowSlot(uint8_t address)
+{
+  // registers only the driver changes, the others (FIFO, IRQ flags, status, RSSI, ...) are always read
+  switch (address) {
+    case REG_OP_MODE:             return 0;
+    case REG_FRF_MSB:             return 1;
+    case REG_FRF_MID:             return 2;
+    case REG_FRF_LSB:             return 3;
+    case REG_PA_CONFIG:           return 4;
+    case REG_OCP:                 return 5;
+    case REG_MODEM_CONFIG_1:      return 6;
+    case REG_MODEM_CONFIG_2:      return 7;
+    case REG_MODEM_CONFIG_3:      return 8;
+    case REG_PREAMBLE_MSB:        return 9;
+    case REG_PREAMBLE_LSB:        return 10;
+    case REG_PAYLOAD_LENGTH:      return 11;
+    case REG_DETECTION_OPTIMIZE:  return 12;
+    case REG_INVERTIQ:            return 13;
+    case REG_DETECTION_THRESHOLD: return 14;
+    case REG_SYNC_WORD:           return 15;
+    case REG_INVERTIQ2:           return 16;
+    case REG_DIO_MAPPING_1:       return 17;
+    default:                      return -1;
+  }
+}
+
+void LoRaClass::updateShadow(uint8_t address, uint8_t value)
+{
+  int slot = shadowSlot(address);
+
+  if (slot < 0) {
+    return;
+  }
+
+  // TX, RX single and CAD end on their own (the radio goes back to standby), so they are never cached
+  uint8_t mode = value & 0x07;
+  if (address == REG_OP_MODE && (mode == MODE_TX || mode == MODE_RX_SINGLE || mode == MODE_CAD)) {
+    _shadowValid[slot] = false;
+    return;
+  }
+
+  _shadow[slot] = value;
+  _shadowValid[slot] = true;
 }
 
 uint8_t LoRaClass::readRegister(uint8_t address)
 {
-  return singleTransfer(address & 0x7f, 0x00);
+  int slot = shadowSlot(address);
+
+  if (slot >= 0 && _shadowValid[slot]) {
+    return _shadow[slot];
+  }
+
+  uint8_t value = singleTransfer(address & 0x7f, 0x00);
+  updateShadow(address, value);
+
+  return value;
 }
 
 void LoRaClass::writeRegister(uint8_t address, uint8_t value)
 {
   singleTransfer(address | 0x80, value);
+  updateShadow(address, value);
+}
+
+void LoRaClass::burstWrite(uint8_t address, const uint8_t *buffer, size_t size)
+{
+  if (size == 0) {
+    return;
+  }
+
+  digitalWrite(_ss, LOW);
+
+  // the address auto-increments except for REG_FIFO, which advances REG_FIFO_ADDR_PTR instead
+  _spiTransactions++;
+  _spi->beginTransaction(_spiSettings);
+  _spi->transfer(address | 0x80);
+  for (size_t i = 0; i < size; i++) {
+    _spi->transfer(buffer[i]);
+  }
+  _spi->endTransaction();
+
+  digitalWrite(_ss, HIGH);
+}
+
+void LoRaClass::burstRead(uint8_t address, uint8_t *buffer, size_t size)
+{
+  if (size == 0) {
+    return;
+  }
+
+  digitalWrite(_ss, LOW);
+
+  _spiTransactions++;
+  _spi->beginTransaction(_spiSettings);
+  _spi->transfer(address & 0x7f);
+  for (size_t i = 0; i < size; i++) {
+    buffer[i] = _spi->transfer(0x00);
+  }
+  _spi->endTransaction();
+
+  digitalWrite(_ss, HIGH);
 }
 
 uint8_t LoRaClass::singleTransfer(uint8_t address, uint8_t value)
@@ -736,6 +1330,7 @@ uint8_t LoRaClass::singleTransfer(uint8_t address, uint8_t value)
 
   digitalWrite(_ss, LOW);
 
+  _spiTransactions++;
   _spi->beginTransaction(_spiSettings);
   _spi->transfer(address);
   response = _spi->transfer(value);
@@ -751,4 +1346,9 @@ ISR_PREFIX void LoRaClass::onDio0Rise()
   LoRa.handleDio0Rise();
 }
 
+ISR_PREFIX void LoRaClass::onDio1Rise()
+{
+  LoRa.handleDio1Rise();
+}
+
 LoRaClass LoRa;
@@ -27,9 +27,61 @@
 #define LORA_DEFAULT_DIO0_PIN      2
 #endif
 
+#define MAX_PKT_LENGTH             255
+
+// receive queue (see enableReceiveQueue()), holds up to LORA_RX_QUEUE_SLOTS - 1 packets
+// and the slot count must be a power of 2, a single packet on boards with 2 KB of SRAM
+#ifndef LORA_RX_QUEUE_SLOTS
+#if defined(__AVR__)
+#define LORA_RX_QUEUE_SLOTS        2
+#else
+#define LORA_RX_QUEUE_SLOTS        4
+#endif
+#endif
+#ifndef LORA_RX_SLOT_SIZE
+#define LORA_RX_SLOT_SIZE          64
+#endif
+
+// transmit queue (see enqueuePacket()), in bytes: each packet takes its length plus
+// LORA_TX_ENTRY_HEADER, the size must be a power of 2 and is smaller on boards with 2 KB of SRAM
+#ifndef LORA_TX_QUEUE_SIZE
+#if defined(__AVR__)
+#define LORA_TX_QUEUE_SIZE         128
+#else
+#define LORA_TX_QUEUE_SIZE         256
+#endif
+#endif
+#define LORA_TX_ENTRY_HEADER       7
+
+// largest packet that fits in the transmit queue
+#define LORA_TX_MAX_PACKET         (LORA_TX_QUEUE_SIZE - LORA_TX_ENTRY_HEADER < MAX_PKT_LENGTH ? \
+                                    LORA_TX_QUEUE_SIZE - LORA_TX_ENTRY_HEADER : MAX_PKT_LENGTH)
+
+// listen before talk (see enableListenBeforeTalk()), busy channels before transmitting anyway
+#ifndef LORA_LBT_MAX_ATTEMPTS
+#define LORA_LBT_MAX_ATTEMPTS      4
+#endif
+
+// receive windows (see enableReceiveWindows()), time in ms a window may stay open past its length
+// while a packet that started in it is being received
+#ifndef LORA_RX_WINDOW_GRACE
+#define LORA_RX_WINDOW_GRACE       3000
+#endif
+
+// number of configuration and mode registers kept in the shadow cache (see shadowSlot())
+#define LORA_SHADOW_REGISTERS      18
+
 #define PA_OUTPUT_RFO_PIN          0
 #define PA_OUTPUT_PA_BOOST_PIN     1
 
+struct LoRaPacket {
+  uint8_t length;
+  int rssi;
+  float snr;
+  unsigned long timestamp; // micros() when the packet was queued
+  uint8_t data[LORA_RX_SLOT_SIZE];
+};
+
 class LoRaClass : public Stream {
 public:
   LoRaClass();
@@ -57,11 +109,33 @@ public:
   virtual int peek();
   virtual void flush();
 
+  size_t readBytes(uint8_t *buffer, size_t length);
+  size_t readBytes(char *buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+
 #ifndef ARDUINO_SAMD_MKRWAN1300
   void onReceive(void(*callback)(int));
   void onTxDone(void(*callback)());
 
   void receive(int size = 0);
+
+  void enableReceiveQueue();
+  void disableReceiveQueue();
+  bool popPacket(LoRaPacket& packet);
+  unsigned int droppedPackets() { return _rxDropped; }
+
+  bool enqueuePacket(const uint8_t *buffer, size_t size, bool implicitHeader = false, long frequency = 0);
+  bool isTxBusy() { return _txBusy; }
+  void poll();
+
+  void enableListenBeforeTalk();
+  void disableListenBeforeTalk();
+  bool isChannelBusy();
+  unsigned int channelBusyCount() { return _channelBusyCount; }
+
+  void enableReceiveWindows(unsigned long length);
+  void disableReceiveWindows();
+  void receiveWindow();
+  bool isReceiveWindowOpen() { return _rxWindowOpen; }
 #endif
   void idle();
   void sleep();
@@ -78,6 +152,8 @@ public:
   void enableInvertIQ();
   void disableInvertIQ();
   
+  unsigned long timeOnAir(int size, int implicitHeader = false);
+
   void setOCP(uint8_t mA); // Over Current Protection control
   
   void setGain(uint8_t gain); // Set LNA gain
@@ -88,29 +164,49 @@ public:
 
   byte random();
 
-  void setPins(int ss = LORA_DEFAULT_SS_PIN, int reset = LORA_DEFAULT_RESET_PIN, int dio0 = LORA_DEFAULT_DIO0_PIN);
+  void setPins(int ss = LORA_DEFAULT_SS_PIN, int reset = LORA_DEFAULT_RESET_PIN, int dio0 = LORA_DEFAULT_DIO0_PIN, int dio1 = -1);
   void setSPI(SPIClass& spi);
   void setSPIFrequency(uint32_t frequency);
 
   void dumpRegisters(Stream& out);
 
+  unsigned long spiTransactions() { return _spiTransactions; }
+  void resetSpiTransactions() { _spiTransactions = 0; }
+
 private:
   void explicitHeaderMode();
   void implicitHeaderMode();
 
   void handleDio0Rise();
+  void handleDio1Rise();
+  void queuePacket(int packetLength);
+  void transmitQueued();
+  void startQueued();
+  void backoffQueued();
+  void listen();
+  void continueWindow();
+  void closeWindow();
+  void restoreFrequency();
   bool isTransmitting();
+  void writeFrequency(uint32_t frf);
 
   int getSpreadingFactor();
   long getSignalBandwidth();
 
   void setLdoFlag();
 
+  void invalidateShadow();
+  static int shadowSlot(uint8_t address);
+  void updateShadow(uint8_t address, uint8_t value);
+
   uint8_t readRegister(uint8_t address);
   void writeRegister(uint8_t address, uint8_t value);
+  void burstWrite(uint8_t address, const uint8_t *buffer, size_t size);
+  void burstRead(uint8_t address, uint8_t *buffer, size_t size);
   uint8_t singleTransfer(uint8_t address, uint8_t value);
 
   static void onDio0Rise();
+  static void onDio1Rise();
 
 private:
   SPISettings _spiSettings;
@@ -118,11 +214,39 @@ private:
   int _ss;
   int _reset;
   int _dio0;
+  int _dio1;
   long _frequency;
+  uint32_t _frf;
   int _packetIndex;
+  int _payloadLength;
   int _implicitHeaderMode;
   void (*_onReceive)(int);
   void (*_onTxDone)();
+  bool _rxQueueEnabled;
+  LoRaPacket _rxQueue[LORA_RX_QUEUE_SLOTS];
+  volatile uint8_t _rxHead;
+  volatile uint8_t _rxTail;
+  volatile unsigned int _rxDropped;
+  int _receiveSize;
+  uint8_t _txQueue[LORA_TX_QUEUE_SIZE];
+  volatile uint16_t _txHead;
+  volatile uint16_t _txTail;
+  volatile bool _txBusy;
+  volatile bool _txBackoff;
+  uint8_t _txSize;
+  uint16_t _txSlot;
+  bool _txImplicit;
+  bool _txHopped;
+  volatile unsigned long _txRetryAt;
+  bool _lbtEnabled;
+  uint8_t _lbtAttempts;
+  volatile unsigned int _channelBusyCount;
+  unsigned long _rxWindowLength;
+  volatile bool _rxWindowOpen;
+  volatile unsigned long _rxWindowStart;
+  uint8_t _shadow[LORA_SHADOW_REGISTERS];
+  volatile bool _shadowValid[LORA_SHADOW_REGISTERS];
+  volatile unsigned long _spiTransactions;
 };
 
 extern LoRaClass LoRa;
@@ -0,0 +1,88 @@
+#include <TinyGPS++.h>
+/*
+   This sample sketch compares the cost of reading a location as a double
+   (lat()/lng(), soft-float on AVR) against the integer-only latE7()/lngE7()
+   accessors, which return the same position in 1e-7 degree units.
+   No device needed: it feeds a static NMEA sentence and reports CPU cycles per call.
+*/
+
+// A sample NMEA stream.
+const char *gpsStream =
+  "$GPRMC,045103.000,A,3434.4849,S,05826.1314,W,0.67,161.46,030913,,,A*60\r\n";
+
+static const unsigned long ITERATIONS = 1000;
+
+// The TinyGPS++ object
+TinyGPSPlus gps;
+
+// Sinks that keep the compiler from optimizing the measured calls away
+volatile int32_t sinkInt;
+volatile double sinkDouble;
+volatile char sinkChar;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  Serial.println(F("FixedPointBenchmark.ino"));
+  Serial.println(F("Cycles per lat()+lng() call pair, double vs. fixed-point (no device needed)"));
+  Serial.print(F("Testing TinyGPS++ library v. ")); Serial.println(TinyGPSPlus::libraryVersion());
+  Serial.println();
+
+  while (*gpsStream)
+    gps.encode(*gpsStream++);
+
+  if (!gps.location.isValid())
+  {
+    Serial.println(F("INVALID location, check the sample sentence."));
+    return;
+  }
+
+  unsigned long start = micros();
+  for (unsigned long i = 0; i < ITERATIONS; ++i)
+  {
+    sinkDouble = gps.location.lat();
+    sinkDouble = gps.location.lng();
+  }
+  report(F("lat()/lng() as double:           "), micros() - start);
+
+  start = micros();
+  for (unsigned long i = 0; i < ITERATIONS; ++i)
+  {
+    sinkInt = (int32_t)(gps.location.lat() * 1e7);
+    sinkInt = (int32_t)(gps.location.lng() * 1e7);
+  }
+  report(F("lat()/lng() scaled to 1e-7:      "), micros() - start);
+
+  start = micros();
+  for (unsigned long i = 0; i < ITERATIONS; ++i)
+  {
+    sinkChar = String(gps.location.lat(), 5)[0];
+    sinkChar = String(gps.location.lng(), 5)[0];
+  }
+  report(F("String(lat()/lng(), 5):          "), micros() - start);
+
+  start = micros();
+  for (unsigned long i = 0; i < ITERATIONS; ++i)
+  {
+    sinkInt = gps.location.latE7();
+    sinkInt = gps.location.lngE7();
+  }
+  report(F("latE7()/lngE7():                 "), micros() - start);
+
+  Serial.println();
+  Serial.print(F("latE7() = ")); Serial.print(gps.location.latE7());
+  Serial.print(F(", lngE7() = ")); Serial.println(gps.location.lngE7());
+  Serial.println(F("Done."));
+}
+
+void loop()
+{
+}
+
+void report(const __FlashStringHelper *label, unsigned long elapsedMicros)
+{
+  Serial.print(label);
+  Serial.print(elapsedMicros * (F_CPU / 1000000UL) / ITERATIONS);
+  Serial.println(F(" cycles"));
+}
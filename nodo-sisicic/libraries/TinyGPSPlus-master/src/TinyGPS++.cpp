@@ -366,6 +366,25 @@ double TinyGPSLocation::lng()
    return rawLngData.negative ? -ret : ret;
 }
 
+int32_t TinyGPSLocation::latE7()
+{
+   updated = false;
+   return rawToE7(rawLatData);
+}
+
+int32_t TinyGPSLocation::lngE7()
+{
+   updated = false;
+   return rawToE7(rawLngData);
+}
+
+// Avoids the soft-float path of lat()/lng(): 180 degrees in 1e-7 units still fits in an int32_t
+int32_t TinyGPSLocation::rawToE7(const RawDegrees &raw)
+{
+   int32_t ret = (int32_t)raw.deg * 10000000L + (int32_t)((raw.billionths + 50) / 100);
+   return raw.negative ? -ret : ret;
+}
+
 void TinyGPSDate::commit()
 {
    date = newDate;
@@ -61,11 +61,14 @@ public:
    const RawDegrees &rawLng()     { updated = false; return rawLngData; }
    double lat();
    double lng();
+   int32_t latE7(); // latitude in 1e-7 degrees, integer math only
+   int32_t lngE7(); // longitude in 1e-7 degrees, integer math only
 
    TinyGPSLocation() : valid(false), updated(false)
    {}
 
 private:
+   static int32_t rawToE7(const RawDegrees &raw);
    bool valid, updated;
    RawDegrees rawLatData, rawLngData, rawNewLatData, rawNewLngData;
    uint32_t lastCommitTime;
@@ -12,6 +12,13 @@
 // Header que contiene constantes relevantes al accionar de este programa.
 #include "constants.h"          // Biblioteca propia.
 
+// Headers que contienen el formato binario de los reportes LoRa.
+#include "report_helpers.h"     // Biblioteca propia.
+#include "report_fields.h"      // Biblioteca propia.
+#include "report_series.h"      // Biblioteca propia.
+#include "report_fragments.h"   // Biblioteca propia.
+#include "channel_plan.h"       // Biblioteca propia.
+
 // Bibliotecas necesarias para manejar al SX1278.
 #include <SPI.h>                // https://www.arduino.cc/en/reference/SPI
 #include <LoRa.h>               // https://github.com/sandeepmistry/arduino-LoRa
@@ -89,10 +96,211 @@ bool gasRequested = true;
 bool GPSRequested = true;
 
 /**
-    outcomingFull es una string que contiene el mensaje LoRa de salida preformateado especialmente
-    para que, posteriormente, el concentrador LoRa pueda decodificarla.
+    outcomingBuffer es un buffer estático de bytes que contiene el mensaje LoRa de salida
+    (reporte binario o de texto) preformateado especialmente para que, posteriormente,
+    el concentrador LoRa pueda decodificarlo. Al ser estático, no fragmenta la memoria heap.
+*/
+uint8_t outcomingBuffer[MAX_SIZE_OUTCOMING_LORA_REPORT];
+
+/**
+    outcomingLength es la cantidad de bytes válidos dentro de outcomingBuffer.
 */
-String outcomingFull;
+size_t outcomingLength = 0;
+
+/**
+    outcomingReport contiene los valores del último reporte compuesto (ver report_helpers.h).
+    Con LORA_EXCEPTION_REPORT, las bandas muertas se evalúan respecto de él.
+*/
+Report outcomingReport;
+
+#ifdef LORA_BATCH_REPORT
+    /**
+        batchBuffer contiene el lote de reportes pendiente de transmisión (ver report_helpers.h).
+    */
+    uint8_t batchBuffer[LORA_TX_MAX_PACKET];
+
+    /**
+        batchLength es la cantidad de bytes válidos dentro de batchBuffer (0 si el lote está vacío).
+    */
+    size_t batchLength = 0;
+
+    /**
+        batchStamps contiene el instante (en ms) en que se compuso cada registro del lote,
+        para calcular su antigüedad al transmitirlo.
+    */
+    unsigned long batchStamps[LORA_BATCH_SIZE];
+#endif
+
+#ifdef LORA_DELTA_REPORT
+    /**
+        referenceReport es el último reporte binario reconocido por el concentrador
+        (mediante el comando "ack<seq>"). Los reportes diferenciales se componen respecto de él.
+    */
+    Report referenceReport;
+
+    /**
+        referenceValid indica si referenceReport contiene un reporte reconocido.
+        Mientras sea false, sólo se transmiten reportes completos.
+    */
+    bool referenceValid = false;
+
+    /**
+        reportsSinceKeyframe cuenta los reportes diferenciales transmitidos desde el último
+        reporte completo. Al llegar a DELTA_KEYFRAME_INTERVAL, se fuerza un reporte completo.
+    */
+    int reportsSinceKeyframe = 0;
+#endif
+
+#ifdef LORA_EXCEPTION_REPORT
+    /**
+        lastTransmission contiene el instante (en ms) en que se transmitió el último reporte.
+    */
+    unsigned long lastTransmission = 0;
+
+    /**
+        reportTransmitted indica si el último reporte compuesto llegó a transmitirse (false al inicio
+        o si lo impidió el ciclo de trabajo). Mientras sea false, el reporte se transmite sin evaluar
+        las bandas muertas.
+    */
+    bool reportTransmitted = false;
+#endif
+
+/**
+    airtimeBuckets contiene el tiempo en el aire (en ms) transmitido en cada subintervalo
+    de la ventana móvil del ciclo de trabajo (ver airtime_helpers.h). El control del ciclo de
+    trabajo está siempre activo; cada subintervalo entra en 16 bits porque nunca supera AIRTIME_BUDGET.
+*/
+uint16_t airtimeBuckets[DUTY_CYCLE_BUCKETS] = {0};
+
+/**
+    airtimeBucket es el índice del subintervalo actual dentro de airtimeBuckets.
+*/
+int airtimeBucket = 0;
+
+/**
+    airtimeBucketStart contiene el instante (en ms) en que comenzó el subintervalo actual.
+*/
+unsigned long airtimeBucketStart = 0;
+
+#ifdef LORA_CONFIRMED_REPORT
+    /**
+        confirmedBuffer contiene el último reporte confirmado transmitido (ver sendConfirmedReport()),
+        de confirmedLength bytes, para poder retransmitirlo.
+    */
+    uint8_t confirmedBuffer[CONFIRMED_MAX_SIZE];
+    size_t confirmedLength = 0;
+
+    /**
+        confirmedSeq contiene el número de secuencia (de 16 bits) del último reporte confirmado.
+        Comienza en un valor aleatorio para que el concentrador no confunda los reportes
+        posteriores a un reinicio con retransmisiones.
+    */
+    uint16_t confirmedSeq = 0;
+
+    /**
+        confirmedState contiene el estado del último reporte confirmado (CONFIRMED_*, ver LoRa_helpers.h),
+        y confirmedDeadline el instante (en ms) en que vence la espera de ese estado.
+    */
+    int confirmedState = 0;
+    unsigned long confirmedDeadline = 0;
+
+    /**
+        confirmedRetries contiene la cantidad de retransmisiones del último reporte confirmado.
+    */
+    int confirmedRetries = 0;
+#endif
+
+#ifdef LORA_TRANSFER
+    /**
+        transferData apunta al bloque de la transferencia fragmentada en curso (ver beginTransfer()),
+        de transferLength bytes, que debe permanecer sin cambios hasta que termine.
+    */
+    const uint8_t* transferData = NULL;
+    size_t transferLength = 0;
+
+    /**
+        transferId contiene el identificador (módulo 256) de la última transferencia.
+        Comienza en un valor aleatorio para que el concentrador no confunda una transferencia
+        posterior a un reinicio con una ya completa del mismo identificador.
+    */
+    uint8_t transferId = 0;
+
+    /**
+        transferPending contiene el mapa de fragmentos pendientes de transmitir
+        (bit i del byte i / 8), y transferLastIndex el último fragmento transmitido.
+    */
+    uint8_t transferPending[REPORT_FRAGMENT_BITMAP_BYTES];
+    uint8_t transferLastIndex = 0;
+
+    /**
+        transferState contiene el estado de la transferencia (TRANSFER_*, ver LoRa_helpers.h),
+        y transferDeadline el instante (en ms) en que vence la espera del mapa de faltantes.
+    */
+    int transferState = 0;
+    unsigned long transferDeadline = 0;
+
+    /**
+        transferRounds contiene la cantidad de rondas de retransmisión de la transferencia.
+    */
+    int transferRounds = 0;
+#endif
+
+#ifdef LORA_TDMA
+    /**
+        tdmaSynced indica si las tramas están sincronizadas con una baliza del concentrador
+        (ver tdma_helpers.h), recibida en el instante (en ms) tdmaBeacon.
+    */
+    bool tdmaSynced = false;
+    unsigned long tdmaBeacon = 0;
+
+    /**
+        tdmaSlotLength contiene la duración (en ms) de cada slot, y tdmaSlotCount
+        la cantidad de slots por trama, indicados por la última baliza.
+    */
+    unsigned long tdmaSlotLength = 0;
+    unsigned long tdmaSlotCount = 1;
+
+    /**
+        tdmaNextSlot contiene el instante (en ms) en que comienza el próximo slot de este nodo.
+    */
+    unsigned long tdmaNextSlot = 0;
+#endif
+
+#ifdef LORA_ADR
+    /**
+        adrTxPower contiene la potencia de transmisión (en dBm) elegida por el ADR (ver adr_helpers.h).
+    */
+    int adrTxPower = 17;
+
+    /**
+        adrPending indica si la potencia elegida aún no se configuró en el módulo.
+    */
+    bool adrPending = false;
+
+    /**
+        adrSnrHistory contiene las últimas SNR (en dB) devueltas por el concentrador
+        con la potencia actual, de las cuales adrSnrCount son válidas.
+        adrSnrIndex es la posición donde se guarda la próxima.
+    */
+    int8_t adrSnrHistory[ADR_HISTORY];
+    int adrSnrCount = 0;
+    int adrSnrIndex = 0;
+
+    /**
+        adrAwaitingAck indica si el último reporte transmitido aún no fue reconocido.
+    */
+    bool adrAwaitingAck = false;
+
+    /**
+        adrMissedAcks contiene la cantidad de reportes seguidos que no fueron reconocidos.
+    */
+    int adrMissedAcks = 0;
+#endif
+
+/**
+    incomingPacket contiene el último paquete LoRa tomado de la cola de recepción.
+*/
+LoRaPacket incomingPacket;
 
 /**
     incomingFull es una string que contiene el mensaje LoRa de entrada, incluyendo
@@ -124,35 +332,28 @@ String incomingPayload;
     se pueden ejecutar.
 */
 const String knownCommands[KNOWN_COMMANDS_SIZE] = {
-    "startAlert"    // inicia una alerta con el siguiente llamado a función: startAlert(750, 10);
+    "startAlert",   // inicia una alerta con el siguiente llamado a función: startAlert(750, 10);
+    "ack",          // reconoce el reporte con el seq indicado, y opcionalmente su SNR en dB (por ejemplo, "ack17,-5"): acknowledgeReport(17, -5);
+    "cnf",          // confirma el reporte confirmado con el seq indicado, y opcionalmente su SNR en dB (por ejemplo, "cnf1234,-5"): confirmReport(1234, -5);
+    "frg",          // indica los fragmentos faltantes de una transferencia (por ejemplo, "frg3,0202"): transferStatus(3, "0202");
+    "bcn"           // baliza del concentrador (por ejemplo, "bcn250,100,200"): processBeacon(250, 100, 200, incomingPacket.timestamp);
 
 };
 
-/**
-    latStr es una String que almacena temporalmente el valor de latitud devuelto por el GPS.
-*/
-String latStr;
-
-/**
-    lngStr es una String que almacena temporalmente el valor de longitud devuelto por el GPS.
-*/
-String lngStr;
-
-/**
-    altStr es una String que almacena temporalmente el valor de altitud devuelto por el GPS.
-*/
-String altStr;
-
 /// Headers finales (proceden a la declaración de variables).
 
 #include "pinout.h"             // Biblioteca propia.
 #include "alerts.h"             // Biblioteca propia.
 #include "timing_helpers.h"     // Biblioteca propia.
 #include "sensors.h"            // Biblioteca propia.
-#include "actuators.h"          // Biblioteca propia.
 #include "decimal_helpers.h"    // Biblioteca propia.
+#include "buffer_helpers.h"     // Biblioteca propia.
 #include "array_helpers.h"      // Biblioteca propia.
+#include "airtime_helpers.h"    // Biblioteca propia.
+#include "adr_helpers.h"        // Biblioteca propia.
+#include "tdma_helpers.h"       // Biblioteca propia.
 #include "LoRa_helpers.h"       // Biblioteca propia.
+#include "actuators.h"          // Biblioteca propia (usa LoRa_helpers.h).
 
 /// Funciones principales.
 
@@ -179,32 +380,40 @@ void setup() {
 
 /**
     loop() determina las tareas que cumple el programa:
-        - cada TIMEOUT_LORA segundos, envía un payload LoRa.
+        - cada TIMEOUT_LORA segundos (con LORA_TDMA, en el slot de este nodo), envía un payload LoRa (con LORA_EXCEPTION_REPORT,
+          sólo si algún campo cambió más que su banda muerta o si vence EXCEPTION_MAX_SILENCE).
+        - con LORA_RX_WINDOWS y LORA_PING_PERIOD, cada LORA_PING_PERIOD segundos abre una ventana de recepción.
         - si no está ocupado con eso:
             - se ocupa de disparar las alertas preestablecidas.
             - cada TIMEOUT_READ_SENSORS segundos, refresca el estado de los sensores.
     Esta función se repite hasta que se le dé un reset al programa.
 */
 void loop() {
-    if (runEvery(sec2ms(TIMEOUT_LORA), 1)) {
+    #ifdef LORA_TDMA
+        // Transmite en el slot de este nodo (o cada TIMEOUT_LORA segundos, sin baliza).
+        bool reportTime = reportSlotDue();
+    #else
+        bool reportTime = runEvery(sec2ms(TIMEOUT_LORA), 1);
+    #endif
+    if (reportTime) {
         // Deja de refrescar TODOS los sensores.
         stopRefreshingAllSensors();
 
-        // Compone la carga útil de LoRa.
-        composeLoRaPayload(currents, raindrops, gas, outcomingFull);
-
-        #if DEBUG_LEVEL >= 1
-            Serial.print("Payload LoRa encolado!: ");
-            Serial.println(outcomingFull);
+        #ifdef LORA_EXCEPTION_REPORT
+            // Transmite sólo si algún campo superó su banda muerta o si vence EXCEPTION_MAX_SILENCE.
+            if (reportDue()) {
+                transmitCurrentReport();
+            }
+        #else
+            transmitCurrentReport();
         #endif
 
-        // Compone y envía el paquete LoRa.
-        LoRa.beginPacket();
-        LoRa.print(outcomingFull);
-        LoRa.endPacket();
-
-        // Pone al módulo LoRa en modo recepción.
-        LoRa.receive();
+        #ifdef LORA_BATCH_REPORT
+            // Transmite el lote si está completo o si esperar otro intervalo excedería BATCH_MAX_DELAY.
+            if (batchDue()) {
+                sendLoRaPacket(batchBuffer, closeBatch());
+            }
+        #endif
 
         // Inicia la alerta preestablecida.
         startAlert(133, 3);
@@ -223,8 +432,31 @@ void loop() {
     // Chequea la necesidad de inicializar alertas.
     callbackAlert();
 
-    // Chequea la necesidad de realizar comandos remotos.
-    callbackLoRaCommand();
+    #if defined(LORA_RX_WINDOWS) && LORA_PING_PERIOD > 0
+        // Escucha los comandos y las balizas que no responden a una transmisión.
+        if (runEvery(sec2ms(LORA_PING_PERIOD), 4)) {
+            LoRa.receiveWindow();
+        }
+    #endif
+
+    // Reintenta la transmisión que encontró el canal ocupado, si venció su espera (y cierra la ventana de recepción vencida).
+    LoRa.poll();
+
+    #ifdef LORA_CONFIRMED_REPORT
+        // Retransmite el reporte confirmado si no llegó su confirmación.
+        callbackConfirmedReport();
+    #endif
+
+    #ifdef LORA_TRANSFER
+        // Transmite los fragmentos pendientes de la transferencia en curso.
+        callbackTransfer();
+    #endif
+
+    // Procesa los paquetes recibidos y realiza sus comandos remotos, de a uno.
+    while (LoRa.popPacket(incomingPacket)) {
+        processIncomingPacket(incomingPacket);
+        callbackLoRaCommand();
+    }
 
     if(runEvery(sec2ms(TIMEOUT_READ_SENSORS), 2)) {
         // Refresca TODOS los sensores dependientes de refreshRequested.
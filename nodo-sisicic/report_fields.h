@@ -0,0 +1,190 @@
+/**
+    Header que contiene la lista de campos del reporte empaquetado (REPORT_TYPE_PACKED).
+    Es la única definición del formato: el nodo la usa para leer los sensores y codificar,
+    y el concentrador para decodificar. Las fuentes (read()) se definen en el nodo (ver LoRa_helpers.h).
+    Cada campo declara acá su escala, ancho y signo; el encoder, el decoder, el tamaño del paquete,
+    la firma y la conversión de unidades entre el Report y el paquete se derivan de esa declaración.
+    Para agregar un sensor, además de declarar su campo acá y sumarlo a PackedReportSchema,
+    hace falta el miembro donde Report guarda el valor (report_helpers.h) y su read() en el nodo:
+    el concentrador comparte Report pero no los sensores, por lo que la fuente no puede vivir acá.
+    Los campos cuyo flag REPORT_FIELD_*_ENABLED (constants.h) sea false se descartan del paquete.
+    @file report_fields.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef REPORT_FIELDS_H
+#define REPORT_FIELDS_H
+
+#include "report_helpers.h"
+#include "report_schema.h"
+
+/// Flags de habilitación (por defecto, todos los campos se transmiten).
+#ifndef REPORT_FIELD_CURRENT_ENABLED
+    #define REPORT_FIELD_CURRENT_ENABLED true
+#endif
+#ifndef REPORT_FIELD_RAINDROPS_ENABLED
+    #define REPORT_FIELD_RAINDROPS_ENABLED true
+#endif
+#ifndef REPORT_FIELD_GAS_ENABLED
+    #define REPORT_FIELD_GAS_ENABLED true
+#endif
+#ifndef REPORT_FIELD_GPS_ENABLED
+    #define REPORT_FIELD_GPS_ENABLED true
+#endif
+#ifndef REPORT_FIELD_AIRTIME_ENABLED
+    #define REPORT_FIELD_AIRTIME_ENABLED true
+#endif
+
+/// Identificadores de campo.
+#define FIELD_ID_CURRENT 1
+#define FIELD_ID_RAINDROPS 2
+#define FIELD_ID_GAS 3
+#define FIELD_ID_LAT 4
+#define FIELD_ID_LNG 5
+#define FIELD_ID_ALT 6
+#define FIELD_ID_AIRTIME 7
+
+/// Formato.
+#define REPORT_TYPE_PACKED 2                // Reporte empaquetado a nivel de bits según PackedReportSchema.
+#define REPORT_PACKED_HEADER_SIZE 5         // | Header | Firma | Dev ID | Seq |
+
+/**
+    CurrentField: corriente promedio, en cA, de 0 a 163.83 A.
+*/
+struct CurrentField : ReportField<FIELD_ID_CURRENT, 100, 14, false, REPORT_FIELD_CURRENT_ENABLED> {
+    static void read(Report& report);
+    static int32_t get(const Report& report) { return toWire(report.current); }
+    static void set(Report& report, int32_t value) { report.current = fromWire(value); }
+};
+
+/**
+    RaindropsField: resultado de la votación de lluvia (-1, 0 ó 1).
+*/
+struct RaindropsField : ReportField<FIELD_ID_RAINDROPS, 1, 2, true, REPORT_FIELD_RAINDROPS_ENABLED> {
+    static void read(Report& report);
+    static int32_t get(const Report& report) { return toWire(report.raindrops); }
+    static void set(Report& report, int32_t value) { report.raindrops = fromWire(value); }
+};
+
+/**
+    GasField: combustible, en dL, de 0 a 1638.3 L.
+*/
+struct GasField : ReportField<FIELD_ID_GAS, 10, 14, false, REPORT_FIELD_GAS_ENABLED> {
+    static void read(Report& report);
+    static int32_t get(const Report& report) { return toWire(report.gas); }
+    static void set(Report& report, int32_t value) { report.gas = fromWire(value); }
+};
+
+/**
+    LatField: latitud, en 1e-5 grados (~1 m), de -167 a 167 grados (el mínimo del campo equivale a "***").
+    Report guarda la latitud en 1e-7 grados.
+*/
+struct LatField : ReportField<FIELD_ID_LAT, 100000L, 25, true, REPORT_FIELD_GPS_ENABLED, 10000000L> {
+    static void read(Report& report);
+    static int32_t get(const Report& report) {
+        return (report.lat == REPORT_UNKNOWN_COORD) ? minValue : toWire(report.lat);
+    }
+    static void set(Report& report, int32_t value) {
+        report.lat = (value == minValue) ? REPORT_UNKNOWN_COORD : fromWire(value);
+    }
+};
+
+/**
+    LngField: longitud, en 1e-5 grados (~1 m), de -335 a 335 grados (el mínimo del campo equivale a "***").
+    Report guarda la longitud en 1e-7 grados.
+*/
+struct LngField : ReportField<FIELD_ID_LNG, 100000L, 26, true, REPORT_FIELD_GPS_ENABLED, 10000000L> {
+    static void read(Report& report);
+    static int32_t get(const Report& report) {
+        return (report.lng == REPORT_UNKNOWN_COORD) ? minValue : toWire(report.lng);
+    }
+    static void set(Report& report, int32_t value) {
+        report.lng = (value == minValue) ? REPORT_UNKNOWN_COORD : fromWire(value);
+    }
+};
+
+/**
+    AltField: altitud, en m, de -8191 a 8191 m (el mínimo del campo equivale a "***").
+*/
+struct AltField : ReportField<FIELD_ID_ALT, 1, 14, true, REPORT_FIELD_GPS_ENABLED> {
+    static void read(Report& report);
+    static int32_t get(const Report& report) { return (report.alt == REPORT_UNKNOWN_ALT) ? minValue : toWire(report.alt); }
+    static void set(Report& report, int32_t value) { report.alt = (value == minValue) ? REPORT_UNKNOWN_ALT : fromWire(value); }
+};
+
+/**
+    AirtimeField: tiempo en el aire consumido en la ventana del ciclo de trabajo, en ds, de 0 a 409.5 s.
+*/
+struct AirtimeField : ReportField<FIELD_ID_AIRTIME, 10, 12, false, REPORT_FIELD_AIRTIME_ENABLED> {
+    static void read(Report& report);
+    static int32_t get(const Report& report) { return toWire(report.airtime); }
+    static void set(Report& report, int32_t value) { report.airtime = fromWire(value); }
+};
+
+/**
+    PackedReportSchema es la lista de campos habilitados del reporte empaquetado, en orden de transmisión.
+*/
+typedef StripDisabled<FieldList<>,
+    CurrentField,
+    RaindropsField,
+    GasField,
+    LatField,
+    LngField,
+    AltField,
+    AirtimeField
+>::type PackedReportSchema;
+
+typedef SchemaCodec<PackedReportSchema> PackedReportCodec;
+
+#define REPORT_PACKED_SIZE (REPORT_PACKED_HEADER_SIZE + PackedReportCodec::bytes)
+
+/**
+    encodePackedReport() serializa un reporte con el formato:
+        | Header | Firma | Dev ID | Seq | Campos de PackedReportSchema (empaquetados a nivel de bits) |
+        |   1    |   1   |   2    |  1  |                  PackedReportCodec::bytes                   |
+    Con todos los campos habilitados ocupa 19 bytes; sin GPS, 11 bytes.
+    @param report Reporte a serializar.
+    @param buf Buffer de salida (de al menos REPORT_PACKED_SIZE bytes).
+    @return Cantidad de bytes escritos.
+*/
+inline size_t encodePackedReport(const Report& report, uint8_t buf[]) {
+    buf[0] = reportHeader(REPORT_TYPE_PACKED);
+    buf[1] = PackedReportCodec::signature;
+    putU16(buf, 2, report.deviceId);
+    buf[4] = report.seq;
+    PackedReportCodec::pack(report, buf + REPORT_PACKED_HEADER_SIZE);
+    return REPORT_PACKED_SIZE;
+}
+
+/**
+    quantizePackedReport() lleva los campos de PackedReportSchema a la resolución con que se transmiten.
+    Conviene aplicarla antes de calcular diferencias con una referencia empaquetada: si no, el ruido
+    por debajo de la resolución del paquete (por ejemplo, la latitud en 1e-7 grados) se transmite como cambio.
+    @param &report Reporte a cuantizar.
+*/
+inline void quantizePackedReport(Report& report) {
+    PackedReportCodec::quantize(report);
+}
+
+/**
+    decodePackedReport() deserializa un reporte generado por encodePackedReport().
+    Los campos deshabilitados conservan el valor que tenían en report.
+    @param buf Buffer de entrada.
+    @param len Cantidad de bytes del buffer.
+    @param &report Reporte a completar.
+    @return true si el buffer es un reporte empaquetado con la misma firma que PackedReportSchema.
+*/
+inline bool decodePackedReport(const uint8_t buf[], size_t len, Report& report) {
+    if (len < REPORT_PACKED_SIZE || buf[0] != reportHeader(REPORT_TYPE_PACKED)
+            || buf[1] != PackedReportCodec::signature) {
+        return false;
+    }
+    report.deviceId = getU16(buf, 2);
+    report.seq = buf[4];
+    PackedReportCodec::unpack(buf + REPORT_PACKED_HEADER_SIZE, report);
+    return true;
+}
+
+#endif
@@ -0,0 +1,247 @@
+/**
+    Header que contiene el formato de las transferencias fragmentadas (REPORT_TYPE_FRAGMENT):
+    un bloque de datos mayor que un paquete LoRa (capturas de forma de onda, historial,
+    configuración) se divide en hasta REPORT_FRAGMENT_MAX_COUNT fragmentos de igual tamaño
+    (salvo el último). El receptor lleva un mapa de bits de los fragmentos recibidos y,
+    cuando el emisor lo pide (REPORT_FRAGMENT_POLL), responde con el mapa de los faltantes,
+    de modo que sólo se retransmiten los huecos.
+    El reensamblado es en flujo: FragmentReassembler sólo guarda el mapa de bits, y cada
+    fragmento nuevo se entrega con su posición dentro del bloque para que el receptor
+    lo copie (o lo escriba en memoria no volátil) directamente.
+    No depende de Arduino, por lo que también puede incluirse desde el concentrador.
+    @file report_fragments.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef REPORT_FRAGMENTS_H
+#define REPORT_FRAGMENTS_H
+
+#include "report_helpers.h"
+
+/// Formato.
+#define REPORT_TYPE_FRAGMENT 6              // Fragmento de una transferencia.
+#define REPORT_FRAGMENT_HEADER_SIZE 7       // | Header | Dev ID | Transferencia | Índice | Cantidad | Tamaño |
+#define REPORT_FRAGMENT_MAX_COUNT 64        // Máxima cantidad de fragmentos por transferencia.
+#define REPORT_FRAGMENT_MAX_DATA (255 - REPORT_FRAGMENT_HEADER_SIZE)   // Máximos bytes de datos por fragmento.
+#define REPORT_FRAGMENT_POLL 0x80           // Bit del índice con que el emisor pide el mapa de faltantes.
+#define REPORT_FRAGMENT_BITMAP_BYTES (REPORT_FRAGMENT_MAX_COUNT / 8)
+
+/// Resultado de acceptFragment().
+#define FRAGMENT_NEW 0                      // Fragmento nuevo (entregar sus datos).
+#define FRAGMENT_DUPLICATE 1                // Fragmento ya recibido.
+#define FRAGMENT_MALFORMED 2                // Fragmento inconsistente con su transferencia.
+
+/**
+    FragmentHeader contiene el encabezado de un fragmento:
+        - deviceId: identificador del nodo.
+        - transfer: identificador de la transferencia (módulo 256).
+        - index: posición del fragmento (0 a count - 1).
+        - count: cantidad de fragmentos de la transferencia.
+        - size: bytes de datos de cada fragmento (el último puede tener menos).
+        - poll: si el emisor pide el mapa de fragmentos faltantes.
+*/
+struct FragmentHeader {
+    uint16_t deviceId;
+    uint8_t transfer;
+    uint8_t index;
+    uint8_t count;
+    uint8_t size;
+    bool poll;
+};
+
+/**
+    FragmentReassembler contiene el estado de la recepción de una transferencia:
+        - header: encabezado del primer fragmento recibido (define la transferencia).
+        - active: si hay una transferencia en curso.
+        - received: cantidad de fragmentos distintos recibidos.
+        - length: tamaño total del bloque (sólo conocido al recibir el último fragmento).
+        - bitmap: fragmentos recibidos (bit i del byte i / 8).
+*/
+struct FragmentReassembler {
+    FragmentHeader header;
+    bool active;
+    uint8_t received;
+    uint32_t length;
+    uint8_t bitmap[REPORT_FRAGMENT_BITMAP_BYTES];
+};
+
+/**
+    fragmentCount() obtiene la cantidad de fragmentos necesarios para un bloque.
+    @param length Tamaño del bloque (en bytes).
+    @param size Bytes de datos por fragmento.
+    @return Cantidad de fragmentos (0 si el bloque excede REPORT_FRAGMENT_MAX_COUNT fragmentos).
+*/
+inline uint8_t fragmentCount(uint32_t length, uint8_t size) {
+    uint32_t count = (length + size - 1) / size;
+    return (count == 0 || count > REPORT_FRAGMENT_MAX_COUNT) ? 0 : count;
+}
+
+/**
+    encodeFragment() serializa un fragmento con el formato:
+        | Header | Dev ID | Transferencia | Índice (+ POLL) | Cantidad | Tamaño | Datos  |
+        |   1    |   2    |       1       |        1        |    1     |   1    | length |
+    @param header Encabezado del fragmento.
+    @param data Datos del fragmento.
+    @param length Cantidad de bytes de datos (header.size, salvo en el último fragmento).
+    @param buf Buffer de salida (de al menos REPORT_FRAGMENT_HEADER_SIZE + length bytes).
+    @return Cantidad de bytes escritos.
+*/
+inline size_t encodeFragment(const FragmentHeader& header, const uint8_t data[], size_t length, uint8_t buf[]) {
+    buf[0] = reportHeader(REPORT_TYPE_FRAGMENT);
+    putU16(buf, 1, header.deviceId);
+    buf[3] = header.transfer;
+    buf[4] = header.index | (header.poll ? REPORT_FRAGMENT_POLL : 0);
+    buf[5] = header.count;
+    buf[6] = header.size;
+    for (size_t i = 0; i < length; i++) {
+        buf[REPORT_FRAGMENT_HEADER_SIZE + i] = data[i];
+    }
+    return REPORT_FRAGMENT_HEADER_SIZE + length;
+}
+
+/**
+    decodeFragment() deserializa un fragmento generado por encodeFragment().
+    @param buf Buffer de entrada.
+    @param len Cantidad de bytes del buffer.
+    @param &header Encabezado del fragmento.
+    @param &data Puntero a los datos dentro del buffer.
+    @param &length Cantidad de bytes de datos.
+    @return true si el buffer es un fragmento con un encabezado válido.
+*/
+inline bool decodeFragment(const uint8_t buf[], size_t len, FragmentHeader& header,
+                           const uint8_t*& data, size_t& length) {
+    if (len <= REPORT_FRAGMENT_HEADER_SIZE || buf[0] != reportHeader(REPORT_TYPE_FRAGMENT)) {
+        return false;
+    }
+    header.deviceId = getU16(buf, 1);
+    header.transfer = buf[3];
+    header.index = buf[4] & ~REPORT_FRAGMENT_POLL;
+    header.poll = (buf[4] & REPORT_FRAGMENT_POLL) != 0;
+    header.count = buf[5];
+    header.size = buf[6];
+    data = buf + REPORT_FRAGMENT_HEADER_SIZE;
+    length = len - REPORT_FRAGMENT_HEADER_SIZE;
+    return header.count > 0 && header.count <= REPORT_FRAGMENT_MAX_COUNT && header.index < header.count
+        && header.size > 0 && length <= header.size && (length == header.size || header.index == header.count - 1);
+}
+
+/**
+    resetReassembler() descarta la transferencia en curso.
+    @param &reassembler Estado de la recepción.
+*/
+inline void resetReassembler(FragmentReassembler& reassembler) {
+    reassembler.active = false;
+    reassembler.received = 0;
+    reassembler.length = 0;
+    for (uint8_t i = 0; i < REPORT_FRAGMENT_BITMAP_BYTES; i++) {
+        reassembler.bitmap[i] = 0;
+    }
+}
+
+/**
+    acceptFragment() registra un fragmento decodificado. Un fragmento de otra transferencia
+    (otro nodo, identificador, cantidad o tamaño) descarta la transferencia en curso y comienza la nueva.
+    @param &reassembler Estado de la recepción.
+    @param header Encabezado del fragmento.
+    @param length Cantidad de bytes de datos del fragmento.
+    @param &offset Posición de los datos dentro del bloque.
+    @return FRAGMENT_NEW, FRAGMENT_DUPLICATE o FRAGMENT_MALFORMED.
+*/
+inline uint8_t acceptFragment(FragmentReassembler& reassembler, const FragmentHeader& header,
+                              size_t length, uint32_t& offset) {
+    if (header.count > REPORT_FRAGMENT_MAX_COUNT || header.index >= header.count || length > header.size) {
+        return FRAGMENT_MALFORMED;
+    }
+    const FragmentHeader& current = reassembler.header;
+    if (!reassembler.active || current.deviceId != header.deviceId || current.transfer != header.transfer
+            || current.count != header.count || current.size != header.size) {
+        resetReassembler(reassembler);
+        reassembler.header = header;
+        reassembler.active = true;
+    }
+
+    uint8_t mask = 1 << (header.index % 8);
+    if (reassembler.bitmap[header.index / 8] & mask) {
+        return FRAGMENT_DUPLICATE;
+    }
+    reassembler.bitmap[header.index / 8] |= mask;
+    reassembler.received++;
+    offset = (uint32_t)header.index * header.size;
+    if (header.index == header.count - 1) {
+        reassembler.length = offset + length;
+    }
+    return FRAGMENT_NEW;
+}
+
+/**
+    reassemblyComplete() determina si se recibieron todos los fragmentos de la transferencia.
+    @param reassembler Estado de la recepción.
+    @return true si la transferencia está completa (su tamaño queda en reassembler.length).
+*/
+inline bool reassemblyComplete(const FragmentReassembler& reassembler) {
+    return reassembler.active && reassembler.received == reassembler.header.count;
+}
+
+/**
+    writeMissingFragments() escribe el mapa de fragmentos faltantes en hexadecimal, dos dígitos
+    por cada 8 fragmentos (el bit i del byte i / 8 indica que falta el fragmento i).
+    Por ejemplo, si de 12 fragmentos faltan el 1 y el 9, escribe "0202".
+    @param reassembler Estado de la recepción.
+    @param out Texto de salida (de al menos 2 * REPORT_FRAGMENT_BITMAP_BYTES + 1 caracteres).
+    @return Cantidad de caracteres escritos (sin contar el '\0' final).
+*/
+inline size_t writeMissingFragments(const FragmentReassembler& reassembler, char out[]) {
+    static const char digits[] = "0123456789abcdef";
+    uint8_t count = reassembler.header.count;
+    size_t pos = 0;
+    for (uint8_t i = 0; i < (count + 7) / 8; i++) {
+        uint8_t missing = ~reassembler.bitmap[i];
+        if (count - i * 8 < 8) {
+            missing &= (1 << (count - i * 8)) - 1;
+        }
+        out[pos++] = digits[missing >> 4];
+        out[pos++] = digits[missing & 0x0F];
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+/**
+    readMissingFragments() lee un mapa de fragmentos faltantes escrito por writeMissingFragments().
+    Los bytes que no figuran en el texto se consideran sin faltantes.
+    @param text Texto hexadecimal (terminado en '\0' o en cualquier otro caracter no hexadecimal).
+    @param bitmap Mapa de faltantes (de REPORT_FRAGMENT_BITMAP_BYTES bytes).
+    @return Cantidad de fragmentos faltantes.
+*/
+inline uint8_t readMissingFragments(const char text[], uint8_t bitmap[]) {
+    uint8_t missing = 0;
+    for (uint8_t i = 0; i < REPORT_FRAGMENT_BITMAP_BYTES * 2; i++) {
+        char c = text[i];
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else {
+            for (uint8_t j = (i + 1) / 2; j < REPORT_FRAGMENT_BITMAP_BYTES; j++) {
+                bitmap[j] = 0;
+            }
+            break;
+        }
+        if (i % 2 == 0) {
+            bitmap[i / 2] = nibble << 4;
+        } else {
+            bitmap[i / 2] |= nibble;
+        }
+        for (uint8_t bit = 0; bit < 4; bit++) {
+            missing += (nibble >> bit) & 1;
+        }
+    }
+    return missing;
+}
+
+#endif
@@ -0,0 +1,453 @@
+/**
+    Header que contiene el formato binario de los reportes LoRa.
+    No depende de Arduino, por lo que también puede incluirse desde el concentrador.
+    @file report_helpers.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.1 17/10/2026
+*/
+
+#ifndef REPORT_HELPERS_H
+#define REPORT_HELPERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Formato.
+#define REPORT_VERSION 2                    // Versión del formato binario (nibble alto del primer byte).
+#define REPORT_TYPE_FULL 0                  // Reporte completo (nibble bajo del primer byte).
+#define REPORT_TYPE_DELTA 1                 // Reporte diferencial respecto de un reporte de referencia.
+#define REPORT_TYPE_BATCH 4                 // Lote de reportes de intervalos consecutivos.
+#define REPORT_TYPE_CONFIRMED 5             // Reporte que el concentrador debe confirmar.
+#define REPORT_FULL_SIZE 19                 // Tamaño del reporte completo (en bytes).
+#define REPORT_DELTA_HEADER_SIZE 6          // Tamaño del encabezado de un reporte diferencial (en bytes).
+#define REPORT_FIELDS 6                     // Cantidad de campos medidos (corriente, lluvia, combustible, lat, lng, alt).
+#define REPORT_DELTA_MAX_SIZE (REPORT_DELTA_HEADER_SIZE + REPORT_FIELDS * 5)   // Peor caso de un reporte diferencial.
+#define REPORT_BATCH_HEADER_SIZE 4          // | Header | Dev ID | Registros |
+#define REPORT_BATCH_RECORD_OVERHEAD 3      // | Antigüedad (s) | Largo | por cada registro.
+#define REPORT_CONFIRMED_HEADER_SIZE 5      // | Header | Dev ID | Seq confirmado |
+#define REPORT_REFERENCE_HISTORY 8          // Reportes que el concentrador recuerda por nodo (referencias válidas).
+#define REPORT_CONFIRMED_HISTORY 8          // Seq confirmados que el concentrador recuerda por nodo (duplicados).
+#define REPORT_UNKNOWN_COORD ((int32_t)0x80000000)  // Latitud/longitud desconocida (equivale a "***").
+#define REPORT_UNKNOWN_ALT ((int16_t)0x8000)        // Altitud desconocida (equivale a "***").
+
+/**
+    Report contiene los valores de un reporte ya escalados a enteros:
+        - deviceId: identificador del nodo.
+        - seq: número de secuencia (módulo 256) del reporte.
+        - current: corriente promedio (en cA).
+        - raindrops: resultado de la votación de lluvia (-1, 0 ó 1).
+        - gas: combustible (en dL).
+        - lat, lng: posición (en 1e-7 grados).
+        - alt: altitud (en m).
+        - airtime: tiempo en el aire consumido en la ventana del ciclo de trabajo (en ds).
+          Sólo viaja en los reportes empaquetados (ver report_fields.h).
+*/
+struct Report {
+    uint16_t deviceId;
+    uint8_t seq;
+    uint16_t current;
+    int8_t raindrops;
+    uint16_t gas;
+    int32_t lat;
+    int32_t lng;
+    int16_t alt;
+    uint16_t airtime;
+};
+
+/**
+    reportHeader() compone el primer byte de un reporte binario.
+    @param type Tipo de reporte (REPORT_TYPE_*).
+    @return Byte con la versión en el nibble alto y el tipo en el nibble bajo.
+*/
+inline uint8_t reportHeader(uint8_t type) {
+    return (REPORT_VERSION << 4) | (type & 0x0F);
+}
+
+/**
+    reportType() obtiene el tipo de un reporte binario, para decidir cómo decodificarlo.
+    @param buf Reporte recibido (de al menos 1 byte).
+    @return Tipo de reporte (REPORT_TYPE_*), ó 0xFF si es de otra versión.
+*/
+inline uint8_t reportType(const uint8_t buf[]) {
+    return ((buf[0] >> 4) == REPORT_VERSION) ? (buf[0] & 0x0F) : 0xFF;
+}
+
+/**
+    putU16() escribe un entero de 16 bits en formato little-endian.
+    @param buf Buffer de salida.
+    @param pos Posición a partir de la cual escribir.
+    @param value Valor a escribir.
+    @return Posición siguiente al último byte escrito.
+*/
+inline size_t putU16(uint8_t buf[], size_t pos, uint16_t value) {
+    buf[pos++] = value & 0xFF;
+    buf[pos++] = value >> 8;
+    return pos;
+}
+
+/**
+    putU32() escribe un entero de 32 bits en formato little-endian.
+    @param buf Buffer de salida.
+    @param pos Posición a partir de la cual escribir.
+    @param value Valor a escribir.
+    @return Posición siguiente al último byte escrito.
+*/
+inline size_t putU32(uint8_t buf[], size_t pos, uint32_t value) {
+    pos = putU16(buf, pos, value & 0xFFFF);
+    return putU16(buf, pos, value >> 16);
+}
+
+/**
+    getU16() lee un entero de 16 bits en formato little-endian.
+    @param buf Buffer de entrada.
+    @param pos Posición del primer byte.
+    @return Valor leído.
+*/
+inline uint16_t getU16(const uint8_t buf[], size_t pos) {
+    return buf[pos] | ((uint16_t)buf[pos + 1] << 8);
+}
+
+/**
+    getU32() lee un entero de 32 bits en formato little-endian.
+    @param buf Buffer de entrada.
+    @param pos Posición del primer byte.
+    @return Valor leído.
+*/
+inline uint32_t getU32(const uint8_t buf[], size_t pos) {
+    return getU16(buf, pos) | ((uint32_t)getU16(buf, pos + 2) << 16);
+}
+
+/**
+    encodeReport() serializa un reporte completo con el siguiente formato:
+        | Header | Dev ID | Seq | Corriente | Lluvia | Combustible | Latitud | Longitud | Altitud |
+        |   1    |   2    |  1  |     2     |   1    |      2      |    4    |    4     |    2    |
+    Por ejemplo, el reporte de texto:
+        "<20009>current=0.65&raindrops=1&gas=123.51/150&lat=-34.57475&lng=-58.43552&alt=15"
+    ocupa 81 bytes, mientras que su equivalente binario ocupa REPORT_FULL_SIZE (19) bytes.
+    @param report Reporte a serializar.
+    @param buf Buffer de salida (de al menos REPORT_FULL_SIZE bytes).
+    @return Cantidad de bytes escritos.
+*/
+inline size_t encodeReport(const Report& report, uint8_t buf[]) {
+    size_t pos = 0;
+    buf[pos++] = reportHeader(REPORT_TYPE_FULL);
+    pos = putU16(buf, pos, report.deviceId);
+    buf[pos++] = report.seq;
+    pos = putU16(buf, pos, report.current);
+    buf[pos++] = (uint8_t)report.raindrops;
+    pos = putU16(buf, pos, report.gas);
+    pos = putU32(buf, pos, (uint32_t)report.lat);
+    pos = putU32(buf, pos, (uint32_t)report.lng);
+    pos = putU16(buf, pos, (uint16_t)report.alt);
+    return pos;
+}
+
+/**
+    decodeReport() deserializa un reporte completo generado por encodeReport().
+    Los campos que el reporte completo no transporta (airtime) quedan en 0.
+    @param buf Buffer de entrada.
+    @param len Cantidad de bytes del buffer.
+    @param &report Reporte a completar.
+    @return true si el buffer contiene un reporte completo de una versión conocida.
+*/
+inline bool decodeReport(const uint8_t buf[], size_t len, Report& report) {
+    if (len < REPORT_FULL_SIZE || buf[0] != reportHeader(REPORT_TYPE_FULL)) {
+        return false;
+    }
+    report.deviceId = getU16(buf, 1);
+    report.seq = buf[3];
+    report.current = getU16(buf, 4);
+    report.raindrops = (int8_t)buf[6];
+    report.gas = getU16(buf, 7);
+    report.lat = (int32_t)getU32(buf, 9);
+    report.lng = (int32_t)getU32(buf, 13);
+    report.alt = (int16_t)getU16(buf, 17);
+    report.airtime = 0;
+    return true;
+}
+
+/**
+    reportField() obtiene uno de los campos medidos de un reporte, en el orden
+    de los bits de la máscara de un reporte diferencial:
+        { Corriente, Lluvia, Combustible, Latitud, Longitud, Altitud }
+    @param report Reporte a consultar.
+    @param field Índice del campo (0 a REPORT_FIELDS - 1).
+    @return Valor del campo.
+*/
+inline int32_t reportField(const Report& report, uint8_t field) {
+    switch (field) {
+        case 0: return report.current;
+        case 1: return report.raindrops;
+        case 2: return report.gas;
+        case 3: return report.lat;
+        case 4: return report.lng;
+        case 5: return report.alt;
+    }
+    return 0;
+}
+
+/**
+    setReportField() modifica uno de los campos medidos de un reporte (ver reportField()).
+    @param &report Reporte a modificar.
+    @param field Índice del campo (0 a REPORT_FIELDS - 1).
+    @param value Nuevo valor del campo.
+*/
+inline void setReportField(Report& report, uint8_t field, int32_t value) {
+    switch (field) {
+        case 0: report.current = (uint16_t)value; break;
+        case 1: report.raindrops = (int8_t)value; break;
+        case 2: report.gas = (uint16_t)value; break;
+        case 3: report.lat = value; break;
+        case 4: report.lng = value; break;
+        case 5: report.alt = (int16_t)value; break;
+    }
+}
+
+/**
+    zigzagEncode() mapea un entero con signo a uno sin signo de forma que los valores
+    de módulo pequeño (positivos o negativos) resulten en números pequeños.
+    Por ejemplo: 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3.
+    @param value Número con signo.
+    @return Número sin signo equivalente.
+*/
+inline uint32_t zigzagEncode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+    zigzagDecode() deshace la transformación de zigzagEncode().
+    @param value Número sin signo.
+    @return Número con signo original.
+*/
+inline int32_t zigzagDecode(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+    putVarint() escribe un entero sin signo en formato varint (7 bits por byte,
+    el bit más significativo indica que el número continúa en el siguiente byte).
+    @param buf Buffer de salida.
+    @param pos Posición a partir de la cual escribir.
+    @param value Valor a escribir.
+    @return Posición siguiente al último byte escrito (a lo sumo 5 bytes).
+*/
+inline size_t putVarint(uint8_t buf[], size_t pos, uint32_t value) {
+    while (value >= 0x80) {
+        buf[pos++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buf[pos++] = value;
+    return pos;
+}
+
+/**
+    getVarint() lee un entero sin signo en formato varint (ver putVarint()).
+    @param buf Buffer de entrada.
+    @param pos Posición del primer byte.
+    @param len Cantidad de bytes del buffer.
+    @param &value Valor leído.
+    @return Posición siguiente al último byte leído, ó 0 si el varint está truncado.
+*/
+inline size_t getVarint(const uint8_t buf[], size_t pos, size_t len, uint32_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35 && pos < len; shift += 7) {
+        uint8_t b = buf[pos++];
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return pos;
+        }
+    }
+    return 0;
+}
+
+/**
+    encodeDeltaReport() serializa sólo los campos de un reporte que cambiaron respecto
+    de un reporte de referencia (el último reconocido por el concentrador), con el formato:
+        | Header | Dev ID | Seq | Seq de referencia | Máscara | Diferencias (zigzag + varint) |
+        |   1    |   2    |  1  |         1         |    1    |         0 a 30 bytes          |
+    El bit i de la máscara indica que el campo i (ver reportField()) está presente.
+    Por ejemplo, si sólo el combustible bajó de 1235 a 1231 dL, el reporte ocupa 7 bytes.
+    @param report Reporte a serializar.
+    @param reference Reporte de referencia.
+    @param buf Buffer de salida (de al menos REPORT_DELTA_MAX_SIZE bytes).
+    @return Cantidad de bytes escritos.
+*/
+inline size_t encodeDeltaReport(const Report& report, const Report& reference, uint8_t buf[]) {
+    size_t pos = 0;
+    buf[pos++] = reportHeader(REPORT_TYPE_DELTA);
+    pos = putU16(buf, pos, report.deviceId);
+    buf[pos++] = report.seq;
+    buf[pos++] = reference.seq;
+    size_t maskPos = pos++;
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < REPORT_FIELDS; i++) {
+        // Se resta en aritmética sin signo para que las diferencias desde/hacia
+        // REPORT_UNKNOWN_COORD no desborden (la suma en el decoder deshace el wrap-around).
+        int32_t diff = (int32_t)((uint32_t)reportField(report, i) - (uint32_t)reportField(reference, i));
+        if (diff != 0) {
+            mask |= 1 << i;
+            pos = putVarint(buf, pos, zigzagEncode(diff));
+        }
+    }
+    buf[maskPos] = mask;
+    return pos;
+}
+
+/**
+    decodeDeltaReport() deserializa un reporte diferencial generado por encodeDeltaReport().
+    @param buf Buffer de entrada.
+    @param len Cantidad de bytes del buffer.
+    @param reference Reporte de referencia (su seq debe coincidir con el indicado en el buffer).
+    @param &report Reporte a completar.
+    @return true si el buffer es un reporte diferencial válido respecto de reference.
+*/
+inline bool decodeDeltaReport(const uint8_t buf[], size_t len, const Report& reference, Report& report) {
+    if (len < REPORT_DELTA_HEADER_SIZE || buf[0] != reportHeader(REPORT_TYPE_DELTA)) {
+        return false;
+    }
+    if (getU16(buf, 1) != reference.deviceId || buf[4] != reference.seq) {
+        return false;
+    }
+    Report decoded = reference;
+    decoded.seq = buf[3];
+    uint8_t mask = buf[5];
+    size_t pos = REPORT_DELTA_HEADER_SIZE;
+    for (uint8_t i = 0; i < REPORT_FIELDS; i++) {
+        if (mask & (1 << i)) {
+            uint32_t value;
+            pos = getVarint(buf, pos, len, value);
+            if (pos == 0) {
+                return false;
+            }
+            setReportField(decoded, i, (int32_t)((uint32_t)reportField(reference, i) + (uint32_t)zigzagDecode(value)));
+        }
+    }
+    report = decoded;
+    return true;
+}
+
+/**
+    Un lote (REPORT_TYPE_BATCH) agrupa reportes de intervalos consecutivos en un único paquete
+    para amortizar el preámbulo y el encabezado LoRa, con el formato:
+        | Header | Dev ID | Registros | Registro 1 | ... | Registro N |
+        |   1    |   2    |     1     |
+    donde cada registro es:
+        | Antigüedad (s) | Largo | Reporte (de cualquier otro tipo, con su propio header) |
+        |       2        |   1   |                        Largo                           |
+    La antigüedad es el tiempo transcurrido entre la composición del registro y la transmisión del lote.
+*/
+
+/**
+    beginBatch() escribe el encabezado de un lote vacío.
+    @param deviceId Identificador del nodo.
+    @param buf Buffer de salida.
+    @return Posición del primer registro.
+*/
+inline size_t beginBatch(uint16_t deviceId, uint8_t buf[]) {
+    buf[0] = reportHeader(REPORT_TYPE_BATCH);
+    putU16(buf, 1, deviceId);
+    buf[3] = 0;
+    return REPORT_BATCH_HEADER_SIZE;
+}
+
+/**
+    appendBatchRecord() agrega un registro al final de un lote.
+    @param buf Buffer del lote.
+    @param pos Posición siguiente al último registro.
+    @param age Antigüedad del registro (en segundos).
+    @param record Reporte a agregar.
+    @param length Cantidad de bytes del reporte (a lo sumo 255).
+    @return Posición siguiente al registro agregado.
+*/
+inline size_t appendBatchRecord(uint8_t buf[], size_t pos, uint16_t age, const uint8_t record[], size_t length) {
+    pos = putU16(buf, pos, age);
+    buf[pos++] = length;
+    for (size_t i = 0; i < length; i++) {
+        buf[pos++] = record[i];
+    }
+    buf[3]++;
+    return pos;
+}
+
+/**
+    nextBatchRecord() recorre los registros de un lote recibido.
+    Por ejemplo:
+        size_t pos = REPORT_BATCH_HEADER_SIZE;
+        while (nextBatchRecord(buf, len, pos, age, record, recordLength)) {
+            decoder.decode(record, recordLength, report);
+        }
+    @param buf Lote recibido.
+    @param len Cantidad de bytes del lote.
+    @param &pos Posición del registro a leer (se avanza al siguiente).
+    @param &age Antigüedad del registro (en segundos).
+    @param &record Puntero al reporte dentro del lote.
+    @param &recordLength Cantidad de bytes del reporte.
+    @return true si se leyó un registro completo.
+*/
+inline bool nextBatchRecord(const uint8_t buf[], size_t len, size_t& pos, uint16_t& age,
+                            const uint8_t*& record, size_t& recordLength) {
+    if (pos + REPORT_BATCH_RECORD_OVERHEAD > len) {
+        return false;
+    }
+    age = getU16(buf, pos);
+    recordLength = buf[pos + 2];
+    if (pos + REPORT_BATCH_RECORD_OVERHEAD + recordLength > len) {
+        return false;
+    }
+    record = buf + pos + REPORT_BATCH_RECORD_OVERHEAD;
+    pos += REPORT_BATCH_RECORD_OVERHEAD + recordLength;
+    return true;
+}
+
+/**
+    Un reporte confirmado (REPORT_TYPE_CONFIRMED) envuelve a otro reporte con un número de
+    secuencia de 16 bits propio del nodo, con el formato:
+        | Header | Dev ID | Seq confirmado | Reporte (de cualquier otro tipo, con su propio header) |
+        |   1    |   2    |       2        |
+    El concentrador lo confirma con el comando "cnf<seq>" y descarta sus retransmisiones
+    (mismo Dev ID y seq) sin dejar de confirmarlas.
+*/
+
+/**
+    encodeConfirmedReport() envuelve un reporte en un reporte confirmado.
+    @param deviceId Identificador del nodo.
+    @param seq Número de secuencia confirmado.
+    @param record Reporte a envolver.
+    @param length Cantidad de bytes del reporte.
+    @param buf Buffer de salida (de al menos REPORT_CONFIRMED_HEADER_SIZE + length bytes).
+    @return Cantidad de bytes escritos.
+*/
+inline size_t encodeConfirmedReport(uint16_t deviceId, uint16_t seq, const uint8_t record[], size_t length, uint8_t buf[]) {
+    buf[0] = reportHeader(REPORT_TYPE_CONFIRMED);
+    putU16(buf, 1, deviceId);
+    putU16(buf, 3, seq);
+    for (size_t i = 0; i < length; i++) {
+        buf[REPORT_CONFIRMED_HEADER_SIZE + i] = record[i];
+    }
+    return REPORT_CONFIRMED_HEADER_SIZE + length;
+}
+
+/**
+    decodeConfirmedReport() obtiene el reporte envuelto en un reporte confirmado.
+    @param buf Reporte confirmado recibido.
+    @param len Cantidad de bytes recibidos.
+    @param &deviceId Identificador del nodo.
+    @param &seq Número de secuencia confirmado.
+    @param &record Puntero al reporte envuelto.
+    @param &recordLength Cantidad de bytes del reporte envuelto.
+    @return true si el buffer es un reporte confirmado no vacío.
+*/
+inline bool decodeConfirmedReport(const uint8_t buf[], size_t len, uint16_t& deviceId, uint16_t& seq,
+                                  const uint8_t*& record, size_t& recordLength) {
+    if (len <= REPORT_CONFIRMED_HEADER_SIZE || buf[0] != reportHeader(REPORT_TYPE_CONFIRMED)) {
+        return false;
+    }
+    deviceId = getU16(buf, 1);
+    seq = getU16(buf, 3);
+    record = buf + REPORT_CONFIRMED_HEADER_SIZE;
+    recordLength = len - REPORT_CONFIRMED_HEADER_SIZE;
+    return true;
+}
+
+#endif
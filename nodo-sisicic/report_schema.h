@@ -0,0 +1,253 @@
+/**
+    Header que contiene las plantillas para definir en tiempo de compilación los campos
+    de un reporte empaquetado a nivel de bits (ver report_fields.h).
+    A partir de una única lista de campos se generan el encoder, el decoder, el tamaño del
+    paquete y una firma de la lista; los campos deshabilitados se descartan de la lista.
+    Es C++11 sin biblioteca estándar, por lo que compila tanto en el nodo como en el concentrador.
+    @file report_schema.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef REPORT_SCHEMA_H
+#define REPORT_SCHEMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+    divideRounded() divide redondeando al entero más cercano.
+    @param value Dividendo.
+    @param divisor Divisor (positivo).
+    @return Cociente redondeado.
+*/
+inline int32_t divideRounded(int32_t value, int32_t divisor) {
+    return (value >= 0) ? (value + divisor / 2) / divisor : (value - divisor / 2) / divisor;
+}
+
+/**
+    ReportField describe un campo del reporte empaquetado:
+        - FieldId: identificador del campo (forma parte de la firma de la lista).
+        - FieldScale: unidades transmitidas por unidad física (por ejemplo, 100 para cA).
+        - FieldBits: ancho del campo en el paquete (1 a 32 bits).
+        - FieldSigned: si el campo se transmite en complemento a 2.
+        - FieldEnabled: si el campo forma parte del paquete.
+        - StorageScale: unidades del Report por unidad física (por defecto, FieldScale).
+          Debe ser múltiplo de FieldScale: el paquete nunca tiene más resolución que el Report.
+    Cada campo concreto hereda de ReportField y agrega:
+        - static void read(Report&): fuente del valor, que lo escribe en el Report (sólo se define en el nodo),
+        - static int32_t get(const Report&) y static void set(Report&, int32_t): acceso al miembro del Report,
+          convirtiendo con toWire() y fromWire() (que derivan la conversión de las escalas).
+    Los valores fuera de rango se saturan; el mínimo de un campo con signo representa "***".
+*/
+template <uint8_t FieldId, int32_t FieldScale, uint8_t FieldBits, bool FieldSigned, bool FieldEnabled = true,
+          int32_t StorageScale = FieldScale>
+struct ReportField {
+    static constexpr uint8_t id = FieldId;
+    static constexpr int32_t scale = FieldScale;
+    static constexpr int32_t storageScale = StorageScale;
+    static constexpr int32_t storageRatio = StorageScale / FieldScale;
+    static constexpr uint8_t bits = FieldBits;
+    static constexpr bool isSigned = FieldSigned;
+    static constexpr bool enabled = FieldEnabled;
+    static constexpr int32_t minValue = FieldSigned ? (int32_t)(-(1LL << (FieldBits - 1))) : 0;
+    static constexpr int32_t maxValue = FieldSigned ? (int32_t)((1LL << (FieldBits - 1)) - 1)
+                                                    : (int32_t)((1LL << FieldBits) - 1);
+
+    static_assert(FieldBits >= 1 && FieldBits <= 32, "El ancho de un campo debe estar entre 1 y 32 bits");
+    static_assert(FieldSigned || FieldBits <= 31, "Un campo sin signo admite a lo sumo 31 bits");
+    static_assert(FieldScale > 0 && StorageScale % FieldScale == 0,
+                  "La escala del Report debe ser múltiplo de la escala transmitida");
+
+    /**
+        clamp() satura un valor al rango representable por el campo.
+        @param value Valor a saturar.
+        @return Valor dentro de [minValue, maxValue].
+    */
+    static inline int32_t clamp(int32_t value) {
+        return (value < minValue) ? minValue : ((value > maxValue) ? maxValue : value);
+    }
+
+    /**
+        toWire() pasa un valor del Report (en 1 / StorageScale) a unidades transmitidas (en 1 / FieldScale),
+        redondeando al entero más cercano.
+        @param stored Valor guardado en el Report.
+        @return Valor a transmitir (sin saturar).
+    */
+    static inline int32_t toWire(int32_t stored) {
+        return (storageRatio == 1) ? stored : divideRounded(stored, storageRatio);
+    }
+
+    /**
+        fromWire() es la inversa de toWire().
+        @param value Valor transmitido.
+        @return Valor a guardar en el Report.
+    */
+    static inline int32_t fromWire(int32_t value) {
+        return value * storageRatio;
+    }
+};
+
+/**
+    FieldList es una lista de tipos de campos (typelist).
+*/
+template <typename... Fields>
+struct FieldList {};
+
+/**
+    AppendIf agrega un campo al final de una FieldList sólo si Keep es true.
+*/
+template <typename List, typename Field, bool Keep>
+struct AppendIf;
+
+template <typename... Fields, typename Field>
+struct AppendIf<FieldList<Fields...>, Field, true> {
+    typedef FieldList<Fields..., Field> type;
+};
+
+template <typename... Fields, typename Field>
+struct AppendIf<FieldList<Fields...>, Field, false> {
+    typedef FieldList<Fields...> type;
+};
+
+/**
+    StripDisabled descarta los campos con enabled == false, conservando el orden.
+    Por ejemplo:
+        StripDisabled<FieldList<>, A, B, C>::type
+    es FieldList<A, C> si B está deshabilitado.
+*/
+template <typename Accumulated, typename... Fields>
+struct StripDisabled {
+    typedef Accumulated type;
+};
+
+template <typename Accumulated, typename Field, typename... Rest>
+struct StripDisabled<Accumulated, Field, Rest...> {
+    typedef typename StripDisabled<typename AppendIf<Accumulated, Field, Field::enabled>::type, Rest...>::type type;
+};
+
+/**
+    putBits() escribe los bits menos significativos de value a partir del bit offset
+    de un buffer (orden LSB primero). Con offset y bits constantes, el compilador
+    lo reduce a unas pocas operaciones por byte.
+    @param buf Buffer de salida.
+    @param offset Posición (en bits) del primer bit a escribir.
+    @param bits Cantidad de bits a escribir.
+    @param value Valor a escribir.
+*/
+inline void putBits(uint8_t buf[], uint16_t offset, uint8_t bits, uint32_t value) {
+    while (bits > 0) {
+        uint8_t shift = offset & 7;
+        uint8_t take = 8 - shift;
+        if (take > bits) {
+            take = bits;
+        }
+        uint8_t mask = (uint8_t)(((1 << take) - 1) << shift);
+        buf[offset >> 3] = (buf[offset >> 3] & ~mask) | ((uint8_t)(value << shift) & mask);
+        value >>= take;
+        offset += take;
+        bits -= take;
+    }
+}
+
+/**
+    getBits() lee bits escritos por putBits().
+    @param buf Buffer de entrada.
+    @param offset Posición (en bits) del primer bit a leer.
+    @param bits Cantidad de bits a leer.
+    @return Valor leído (sin extensión de signo).
+*/
+inline uint32_t getBits(const uint8_t buf[], uint16_t offset, uint8_t bits) {
+    uint32_t value = 0;
+    uint8_t done = 0;
+    while (done < bits) {
+        uint8_t shift = offset & 7;
+        uint8_t take = 8 - shift;
+        if (take > bits - done) {
+            take = bits - done;
+        }
+        uint32_t chunk = (buf[offset >> 3] >> shift) & ((1 << take) - 1);
+        value |= chunk << done;
+        offset += take;
+        done += take;
+    }
+    return value;
+}
+
+/**
+    SchemaCodec genera, para una FieldList, el encoder y el decoder a nivel de bits.
+    El desplazamiento de cada campo (Offset) se calcula en tiempo de compilación,
+    por lo que pack() y unpack() resultan en código lineal, sin búsquedas en tiempo de ejecución.
+        - bits, bytes: tamaño total de los campos.
+        - count: cantidad de campos.
+        - signature: firma de la lista (identificadores, anchos y signos).
+        - fill(report): completa el Report a partir de las fuentes de cada campo.
+        - pack(report, buf): escribe los campos en buf.
+        - unpack(buf, report): lee los campos de buf.
+        - quantize(report): lleva los campos del Report a la resolución (y el rango) con que se transmiten,
+          como si se los empaquetara y desempaquetara.
+*/
+template <typename List, uint16_t Offset = 0>
+struct SchemaCodec;
+
+template <uint16_t Offset>
+struct SchemaCodec<FieldList<>, Offset> {
+    static constexpr uint16_t bits = 0;
+    static constexpr uint16_t bytes = 0;
+    static constexpr uint8_t count = 0;
+    static constexpr uint8_t signature = 0;
+
+    template <typename R>
+    static inline void fill(R&) {}
+
+    template <typename R>
+    static inline void pack(const R&, uint8_t[]) {}
+
+    template <typename R>
+    static inline void unpack(const uint8_t[], R&) {}
+
+    template <typename R>
+    static inline void quantize(R&) {}
+};
+
+template <typename Field, typename... Rest, uint16_t Offset>
+struct SchemaCodec<FieldList<Field, Rest...>, Offset> {
+    typedef SchemaCodec<FieldList<Rest...>, Offset + Field::bits> Next;
+
+    static constexpr uint16_t bits = Field::bits + Next::bits;
+    static constexpr uint16_t bytes = (bits + 7) / 8;
+    static constexpr uint8_t count = 1 + Next::count;
+    static constexpr uint8_t signature = (uint8_t)(((Next::signature << 1) | (Next::signature >> 7))
+                                                   ^ (Field::id * 13 + Field::bits * 3 + Field::isSigned));
+
+    template <typename R>
+    static inline void fill(R& report) {
+        Field::read(report);
+        Next::fill(report);
+    }
+
+    template <typename R>
+    static inline void pack(const R& report, uint8_t buf[]) {
+        putBits(buf, Offset, Field::bits, (uint32_t)Field::clamp(Field::get(report)));
+        Next::pack(report, buf);
+    }
+
+    template <typename R>
+    static inline void unpack(const uint8_t buf[], R& report) {
+        uint32_t raw = getBits(buf, Offset, Field::bits);
+        if (Field::isSigned && Field::bits < 32 && (raw & (1UL << (Field::bits - 1)))) {
+            raw |= ~(uint32_t)0 << (Field::bits & 31);
+        }
+        Field::set(report, (int32_t)raw);
+        Next::unpack(buf, report);
+    }
+
+    template <typename R>
+    static inline void quantize(R& report) {
+        Field::set(report, Field::clamp(Field::get(report)));
+        Next::quantize(report);
+    }
+};
+
+#endif
@@ -0,0 +1,108 @@
+/**
+    Header que contiene el formato del reporte de serie temporal de corriente (REPORT_TYPE_SERIES):
+    en lugar del promedio, transmite todas las muestras tomadas entre dos transmisiones,
+    cuantizadas a 8 ó 12 bits respecto de la muestra máxima del paquete.
+    No depende de Arduino, por lo que también puede incluirse desde el concentrador.
+    @file report_series.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef REPORT_SERIES_H
+#define REPORT_SERIES_H
+
+#include "report_helpers.h"
+#include "report_schema.h"
+
+/// Formato.
+#define REPORT_TYPE_SERIES 3                // Serie temporal de corriente.
+#define REPORT_SERIES_HEADER_SIZE 8         // | Header | Dev ID | Seq | Muestras | Bits | Máximo |
+#define REPORT_SERIES_MAX_SAMPLES 160       // Máxima cantidad de muestras (a 12 bits, ocupa 248 bytes).
+#define REPORT_SERIES_SIZE(samples, bits) (REPORT_SERIES_HEADER_SIZE + ((samples) * (bits) + 7) / 8)
+
+/**
+    SeriesReport contiene una serie temporal de corriente decodificada:
+        - deviceId: identificador del nodo.
+        - seq: número de secuencia del reporte al que acompaña.
+        - count: cantidad de muestras.
+        - samples: muestras reconstruidas (en cA).
+*/
+struct SeriesReport {
+    uint16_t deviceId;
+    uint8_t seq;
+    uint8_t count;
+    uint16_t samples[REPORT_SERIES_MAX_SAMPLES];
+};
+
+/**
+    encodeSeriesReport() serializa una serie de muestras con el formato:
+        | Header | Dev ID | Seq | Muestras | Bits | Máximo (cA) | Muestras cuantizadas |
+        |   1    |   2    |  1  |    1     |  1   |      2      |  (muestras * bits) / 8 |
+    Cada muestra se transmite como round(muestra * (2^bits - 1) / máximo), por lo que
+    el error de cuantización es a lo sumo máximo / (2 * (2^bits - 1)).
+    Por ejemplo, 13 muestras a 12 bits ocupan 28 bytes; a 8 bits, 21 bytes.
+    @param deviceId Identificador del nodo.
+    @param seq Número de secuencia del reporte al que acompaña.
+    @param samples Muestras (en cA).
+    @param count Cantidad de muestras (a lo sumo REPORT_SERIES_MAX_SAMPLES).
+    @param bits Bits por muestra (8 ó 12).
+    @param buf Buffer de salida (de al menos REPORT_SERIES_SIZE(count, bits) bytes).
+    @return Cantidad de bytes escritos.
+*/
+inline size_t encodeSeriesReport(uint16_t deviceId, uint8_t seq, const uint16_t samples[], uint8_t count,
+                                 uint8_t bits, uint8_t buf[]) {
+    uint16_t maxSample = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (samples[i] > maxSample) {
+            maxSample = samples[i];
+        }
+    }
+
+    buf[0] = reportHeader(REPORT_TYPE_SERIES);
+    putU16(buf, 1, deviceId);
+    buf[3] = seq;
+    buf[4] = count;
+    buf[5] = bits;
+    putU16(buf, 6, maxSample);
+
+    const uint32_t levels = (1UL << bits) - 1;
+    uint8_t* packed = buf + REPORT_SERIES_HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t quantized = (maxSample == 0) ? 0 : ((uint32_t)samples[i] * levels + maxSample / 2) / maxSample;
+        putBits(packed, (uint16_t)i * bits, bits, quantized);
+    }
+    return REPORT_SERIES_SIZE(count, bits);
+}
+
+/**
+    decodeSeriesReport() deserializa una serie generada por encodeSeriesReport().
+    @param buf Buffer de entrada.
+    @param len Cantidad de bytes del buffer.
+    @param &report Serie a completar.
+    @return true si el buffer contiene una serie completa con 8 ó 12 bits por muestra.
+*/
+inline bool decodeSeriesReport(const uint8_t buf[], size_t len, SeriesReport& report) {
+    if (len < REPORT_SERIES_HEADER_SIZE || buf[0] != reportHeader(REPORT_TYPE_SERIES)) {
+        return false;
+    }
+    uint8_t count = buf[4];
+    uint8_t bits = buf[5];
+    if ((bits != 8 && bits != 12) || count > REPORT_SERIES_MAX_SAMPLES || len < (size_t)REPORT_SERIES_SIZE(count, bits)) {
+        return false;
+    }
+
+    report.deviceId = getU16(buf, 1);
+    report.seq = buf[3];
+    report.count = count;
+    const uint16_t maxSample = getU16(buf, 6);
+    const uint32_t levels = (1UL << bits) - 1;
+    const uint8_t* packed = buf + REPORT_SERIES_HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t quantized = getBits(packed, (uint16_t)i * bits, bits);
+        report.samples[i] = (quantized * maxSample + levels / 2) / levels;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,98 @@
+/**
+    Header que contiene la transmisión por slots (TDMA): el concentrador transmite periódicamente
+    a BROADCAST_ID una baliza "bcn<época>,<largo de slot>,<cantidad de slots>", donde la época es
+    el tiempo (en ms) transcurrido desde el comienzo de la trama al transmitirla. Cada trama dura
+    largo de slot * cantidad de slots, y este nodo transmite su reporte en el slot DEVICE_ID % cantidad
+    de slots, TDMA_GUARD ms después de su comienzo.
+    Sin baliza (o si la última tiene más de TDMA_BEACON_TIMEOUT segundos), transmite cada TIMEOUT_LORA segundos.
+    Sólo se compila si LORA_TDMA está definido.
+    @file tdma_helpers.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifdef LORA_TDMA
+/**
+    tdmaFrameLength() obtiene la duración de una trama.
+    @return Duración de la trama (en ms).
+*/
+unsigned long tdmaFrameLength() {
+    return tdmaSlotLength * tdmaSlotCount;
+}
+
+/**
+    processBeacon() se encarga de sincronizar las tramas con una baliza del concentrador
+    y de calcular el comienzo del próximo slot de este nodo.
+    @param epoch Tiempo (en ms) transcurrido desde el comienzo de la trama al transmitir la baliza.
+    @param slotLength Duración de cada slot (en ms).
+    @param slotCount Cantidad de slots por trama.
+    @param received Instante (en us, ver LoRaPacket) en que se recibió la baliza.
+*/
+void processBeacon(long epoch, long slotLength, long slotCount, unsigned long received) {
+    if (epoch < 0 || slotLength <= 2 * TDMA_GUARD || slotCount <= 0) {
+        #if DEBUG_LEVEL >= 1
+            Serial.println("Baliza descartada!");
+        #endif
+        return;
+    }
+    tdmaSlotLength = slotLength;
+    tdmaSlotCount = slotCount;
+    tdmaBeacon = millis() - (micros() - received) / 1000;
+    tdmaSynced = true;
+
+    // Comienzo (más el margen) del slot de este nodo en la trama de la baliza.
+    unsigned long slotStart = tdmaBeacon - epoch + (DEVICE_ID % tdmaSlotCount) * tdmaSlotLength + TDMA_GUARD;
+    long elapsed = millis() - slotStart;
+    if (elapsed > 0) {
+        slotStart += (elapsed + tdmaFrameLength() - 1) / tdmaFrameLength() * tdmaFrameLength();
+    }
+    tdmaNextSlot = slotStart;
+
+    #if DEBUG_LEVEL >= 2
+        Serial.print("Baliza: slot ");
+        Serial.print(DEVICE_ID % tdmaSlotCount);
+        Serial.print(" de ");
+        Serial.print(tdmaSlotCount);
+        Serial.print(", en (ms): ");
+        Serial.println(tdmaNextSlot - millis());
+    #endif
+}
+
+/**
+    reportSlotDue() determina si es momento de transmitir el reporte:
+        - sincronizado, al comenzar el slot de este nodo. Si llega tarde (por ejemplo, por una
+          medición que demoró el loop) y el último reporte ya no entraría en lo que resta del slot,
+          lo pierde y espera el de la trama siguiente,
+        - sin sincronizar, cada TIMEOUT_LORA segundos.
+    @return true si el reporte debe transmitirse.
+*/
+bool reportSlotDue() {
+    if (tdmaSynced && millis() - tdmaBeacon > sec2ms(TDMA_BEACON_TIMEOUT)) {
+        #if DEBUG_LEVEL >= 1
+            Serial.println("Baliza vencida, transmisión sin slots!");
+        #endif
+        tdmaSynced = false;
+    }
+    if (!tdmaSynced) {
+        return runEvery(sec2ms(TIMEOUT_LORA), 1);
+    }
+
+    long late = millis() - tdmaNextSlot;
+    if (late < 0) {
+        return false;
+    }
+    // Avanza al slot de la trama siguiente (o más, si el loop estuvo detenido varias tramas).
+    tdmaNextSlot += (late / tdmaFrameLength() + 1) * tdmaFrameLength();
+    late %= tdmaFrameLength();
+
+    unsigned long latest = tdmaSlotLength - 2 * TDMA_GUARD;
+    if ((unsigned long)late + packetAirtime(outcomingLength) > latest) {
+        #if DEBUG_LEVEL >= 1
+            Serial.println("Slot perdido!");
+        #endif
+        return false;
+    }
+    return true;
+}
+#endif
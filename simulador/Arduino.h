@@ -0,0 +1,176 @@
+/**
+    Header que reemplaza al núcleo de Arduino para compilar la biblioteca LoRa en Linux,
+    sin hardware, contra el emulador del SX1278 (ver sx1278_emulator.h).
+    El tiempo es virtual: sólo avanza con delay(), yield() y las transacciones SPI, y en cada
+    avance los dispositivos emulados ejecutan sus eventos (fin de una transmisión, llegada de
+    un paquete) en el instante exacto en que ocurren. Las interrupciones de los pines se
+    despachan en cuanto están habilitadas (fuera de noInterrupts() y de las transacciones SPI
+    que las enmascaran con usingInterrupt()), y se mide su duración en tiempo virtual.
+    @file Arduino.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef SIMULADOR_ARDUINO_H
+#define SIMULADOR_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+/// Pines e interrupciones.
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) >= 0 && (p) < HOST_PINS ? (p) : NOT_AN_INTERRUPT)
+
+/// Bases de Print.
+#define BIN 2
+#define DEC 10
+#define HEX 16
+
+/// Bits.
+#define B111 7
+#define B1000 8
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+/// Simulación.
+#define HOST_PINS 64                        // Cantidad de pines (e interrupciones) simulados.
+#define HOST_NEVER UINT64_MAX               // Instante de un evento que no va a ocurrir.
+#define HOST_YIELD_NS 1000                  // Avance del reloj por cada yield() (en ns).
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+void attachInterrupt(uint8_t interruptNum, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void noInterrupts();
+void interrupts();
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+/**
+    Print es la base de los flujos de salida, con las sobrecargas de print() que usa la biblioteca.
+*/
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+
+    size_t print(const char str[]) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template<typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template<typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+/**
+    Stream es la base de los flujos de entrada y salida (LoRaClass deriva de Stream).
+*/
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+
+protected:
+    unsigned long _timeout = 1000;
+};
+
+/**
+    HardwareSerial escribe en la salida estándar, y nunca tiene datos para leer.
+*/
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    using Print::write;
+    size_t write(uint8_t value) { return fputc(value, stdout) == EOF ? 0 : 1; }
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+    void flush() { fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+/**
+    HostDevice es la interfaz de los dispositivos emulados que tienen eventos propios,
+    registrados con hostAddDevice().
+*/
+class HostDevice {
+public:
+    virtual ~HostDevice() {}
+
+    /**
+        nextEvent() obtiene el instante del próximo evento del dispositivo.
+        @return Instante (en ns de tiempo virtual), o HOST_NEVER si no hay ninguno.
+    */
+    virtual uint64_t nextEvent() = 0;
+
+    /**
+        runEvent() ejecuta el evento de nextEvent(), con el reloj ya en ese instante.
+        No debe avanzar el reloj: las interrupciones que cause se despachan al terminar.
+    */
+    virtual void runEvent() = 0;
+};
+
+/**
+    InterruptStats contiene las estadísticas de una interrupción, en tiempo virtual:
+        - count: cantidad de veces que se ejecutó.
+        - coalesced: flancos que llegaron con la anterior todavía pendiente (y se perdieron).
+        - totalDuration, maxDuration: duración del ISR (en ns).
+*/
+struct InterruptStats {
+    unsigned long count;
+    unsigned long coalesced;
+    uint64_t totalDuration;
+    uint64_t maxDuration;
+};
+
+void hostAddDevice(HostDevice* device);
+void hostRemoveDevice(HostDevice* device);
+uint64_t hostNanos();
+void hostAdvance(uint64_t ns);
+void hostSetPin(uint8_t pin, uint8_t level);
+bool hostInInterrupt();
+const InterruptStats& hostInterruptStats(uint8_t interruptNum);
+void hostResetInterruptStats();
+
+#endif
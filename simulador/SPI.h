@@ -0,0 +1,60 @@
+/**
+    Header que reemplaza a la biblioteca SPI de Arduino en Linux (ver Arduino.h).
+    Los métodos de SPIClass son virtuales para que un dispositivo emulado (ver sx1278_emulator.h)
+    ocupe su lugar con LoRa.setSPI(). Igual que en AVR, las interrupciones registradas con
+    usingInterrupt() quedan enmascaradas durante cada transacción, en cualquier instancia.
+    Sin dispositivo, el bus responde 0xFF (MISO en alto).
+    @file SPI.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef SIMULADOR_SPI_H
+#define SIMULADOR_SPI_H
+
+#include <Arduino.h>
+
+#define SPI_HAS_TRANSACTION 1
+#define SPI_HAS_NOTUSINGINTERRUPT 1
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+/**
+    SPISettings contiene la configuración de una transacción.
+*/
+class SPISettings {
+public:
+    SPISettings(uint32_t clock = 4000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+/**
+    SPIClass es el bus SPI. Las clases derivadas que redefinen beginTransaction() y
+    endTransaction() deben llamar a las de SPIClass, que enmascaran las interrupciones.
+*/
+class SPIClass {
+public:
+    virtual ~SPIClass() {}
+    virtual void begin() {}
+    virtual void end() {}
+    virtual void beginTransaction(SPISettings settings);
+    virtual uint8_t transfer(uint8_t) { return 0xFF; }
+    virtual void endTransaction();
+
+    void usingInterrupt(uint8_t interruptNumber);
+    void notUsingInterrupt(uint8_t interruptNumber);
+};
+
+extern SPIClass SPI;
+
+#endif
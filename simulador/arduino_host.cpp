@@ -0,0 +1,313 @@
+/**
+    Implementación del núcleo de Arduino y de la biblioteca SPI para Linux (ver Arduino.h y SPI.h):
+    reloj virtual, pines, interrupciones y dispositivos emulados.
+    @file arduino_host.cpp
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <Arduino.h>
+#include <SPI.h>
+
+HardwareSerial Serial;
+SPIClass SPI;
+
+/**
+    PinState contiene el estado de un pin y de su interrupción:
+        - level: nivel actual (escrito por el programa o por un dispositivo emulado).
+        - isr, mode: rutina y flanco de la interrupción (isr es NULL si no está conectada).
+        - pending: si hay un flanco esperando que se habiliten las interrupciones.
+        - usedBySpi: si usingInterrupt() la enmascara durante las transacciones SPI.
+        - stats: estadísticas de la interrupción.
+*/
+struct PinState {
+    uint8_t level;
+    void (*isr)(void);
+    int mode;
+    bool pending;
+    bool usedBySpi;
+    InterruptStats stats;
+};
+
+static uint64_t nanos = 0;
+static PinState pins[HOST_PINS];
+static bool interruptsEnabled = true;
+static bool inInterrupt = false;
+static int spiTransactionDepth = 0;
+static uint32_t randomState = 20009;
+
+/**
+    hostDevices() obtiene la lista de dispositivos emulados. Es local a la función para que
+    esté construida aunque un dispositivo global se registre antes de la inicialización de este archivo.
+    @return Dispositivos registrados.
+*/
+static std::vector<HostDevice*>& hostDevices() {
+    static std::vector<HostDevice*> devices;
+    return devices;
+}
+
+/**
+    dispatchInterrupts() ejecuta las interrupciones pendientes que estén habilitadas, de a una y en
+    orden de número (como en AVR). Las que quedan enmascaradas se ejecutan al habilitarse.
+*/
+static void dispatchInterrupts() {
+    bool dispatched = true;
+    while (dispatched && interruptsEnabled && !inInterrupt) {
+        dispatched = false;
+        for (int i = 0; i < HOST_PINS; i++) {
+            PinState& pin = pins[i];
+            if (!pin.pending || pin.isr == NULL || (pin.usedBySpi && spiTransactionDepth > 0)) {
+                continue;
+            }
+            pin.pending = false;
+            uint64_t start = nanos;
+
+            // Como en AVR, el ISR corre con las interrupciones deshabilitadas.
+            inInterrupt = true;
+            interruptsEnabled = false;
+            pin.isr();
+            interruptsEnabled = true;
+            inInterrupt = false;
+
+            uint64_t duration = nanos - start;
+            pin.stats.count++;
+            pin.stats.totalDuration += duration;
+            pin.stats.maxDuration = std::max(pin.stats.maxDuration, duration);
+            dispatched = true;
+            break;
+        }
+    }
+}
+
+void hostAddDevice(HostDevice* device) {
+    hostDevices().push_back(device);
+}
+
+void hostRemoveDevice(HostDevice* device) {
+    std::vector<HostDevice*>& devices = hostDevices();
+    devices.erase(std::remove(devices.begin(), devices.end(), device), devices.end());
+}
+
+uint64_t hostNanos() {
+    return nanos;
+}
+
+/**
+    hostAdvance() avanza el reloj virtual, ejecutando en orden los eventos de los dispositivos
+    que ocurren mientras tanto y despachando las interrupciones que causan. Un ISR despachado
+    también avanza el reloj (con sus transacciones SPI), por lo que al volver puede haberse
+    pasado del instante pedido.
+    @param ns Nanosegundos a avanzar.
+*/
+void hostAdvance(uint64_t ns) {
+    std::vector<HostDevice*>& devices = hostDevices();
+    uint64_t target = nanos + ns;
+    for (;;) {
+        HostDevice* next = NULL;
+        uint64_t when = HOST_NEVER;
+        for (size_t i = 0; i < devices.size(); i++) {
+            uint64_t event = devices[i]->nextEvent();
+            if (event < when) {
+                when = event;
+                next = devices[i];
+            }
+        }
+        if (next == NULL || when > std::max(nanos, target)) {
+            break;
+        }
+        nanos = std::max(nanos, when);
+        next->runEvent();
+        dispatchInterrupts();
+    }
+    nanos = std::max(nanos, target);
+}
+
+/**
+    hostSetPin() fija el nivel de un pin de entrada desde un dispositivo emulado
+    (por ejemplo, DIO0), y registra el flanco si dispara su interrupción.
+    @param pin Número de pin.
+    @param level LOW o HIGH.
+*/
+void hostSetPin(uint8_t pin, uint8_t level) {
+    if (pin >= HOST_PINS) {
+        return;
+    }
+    PinState& state = pins[pin];
+    uint8_t previous = state.level;
+    state.level = level;
+    if (state.isr == NULL || previous == level) {
+        return;
+    }
+    bool edge = state.mode == CHANGE || (state.mode == RISING && level == HIGH) || (state.mode == FALLING && level == LOW);
+    if (!edge) {
+        return;
+    }
+    if (state.pending) {
+        state.stats.coalesced++;
+        return;
+    }
+    state.pending = true;
+}
+
+bool hostInInterrupt() {
+    return inInterrupt;
+}
+
+const InterruptStats& hostInterruptStats(uint8_t interruptNum) {
+    return pins[interruptNum % HOST_PINS].stats;
+}
+
+void hostResetInterruptStats() {
+    for (int i = 0; i < HOST_PINS; i++) {
+        pins[i].stats = InterruptStats();
+    }
+}
+
+unsigned long millis() {
+    return nanos / 1000000;
+}
+
+unsigned long micros() {
+    return nanos / 1000;
+}
+
+void delay(unsigned long ms) {
+    hostAdvance((uint64_t)ms * 1000000);
+}
+
+void delayMicroseconds(unsigned int us) {
+    hostAdvance((uint64_t)us * 1000);
+}
+
+void yield() {
+    hostAdvance(HOST_YIELD_NS);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < HOST_PINS && mode == INPUT_PULLUP) {
+        pins[pin].level = HIGH;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < HOST_PINS) {
+        pins[pin].level = value ? HIGH : LOW;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_PINS ? pins[pin].level : LOW;
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*isr)(void), int mode) {
+    if (interruptNum >= HOST_PINS) {
+        return;
+    }
+    pins[interruptNum].isr = isr;
+    pins[interruptNum].mode = mode;
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+    if (interruptNum >= HOST_PINS) {
+        return;
+    }
+    pins[interruptNum].isr = NULL;
+    pins[interruptNum].pending = false;
+}
+
+void noInterrupts() {
+    interruptsEnabled = false;
+}
+
+void interrupts() {
+    interruptsEnabled = true;
+    dispatchInterrupts();
+}
+
+/**
+    nextRandom() genera un número pseudoaleatorio (xorshift32), para que cada ejecución sea igual.
+    @return Siguiente número.
+*/
+static uint32_t nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+long random(long howBig) {
+    return howBig <= 0 ? 0 : nextRandom() % howBig;
+}
+
+long random(long howSmall, long howBig) {
+    return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) {
+        randomState = seed;
+    }
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::print(long n, int base) {
+    if (base == DEC && n < 0) {
+        return print('-') + print(-(unsigned long)n, base);
+    }
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+    char digits[8 * sizeof(unsigned long) + 1];
+    char* str = &digits[sizeof(digits) - 1];
+    *str = '\0';
+    if (base < 2) {
+        base = DEC;
+    }
+    do {
+        unsigned long digit = n % base;
+        n /= base;
+        *--str = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    } while (n > 0);
+    return write(str);
+}
+
+size_t Print::print(double n, int digits) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, n);
+    return write(text);
+}
+
+void SPIClass::beginTransaction(SPISettings) {
+    spiTransactionDepth++;
+}
+
+void SPIClass::endTransaction() {
+    if (spiTransactionDepth > 0) {
+        spiTransactionDepth--;
+    }
+    dispatchInterrupts();
+}
+
+void SPIClass::usingInterrupt(uint8_t interruptNumber) {
+    if (interruptNumber < HOST_PINS) {
+        pins[interruptNumber].usedBySpi = true;
+    }
+}
+
+void SPIClass::notUsingInterrupt(uint8_t interruptNumber) {
+    if (interruptNumber < HOST_PINS) {
+        pins[interruptNumber].usedBySpi = false;
+    }
+}
@@ -0,0 +1,182 @@
+/**
+    Header que contiene el modelo del canal de radio compartido por el simulador de flota
+    (ver fleet_simulator.cpp): tiempo en el aire, pérdida de trayecto, sensibilidad y efecto captura.
+        - La pérdida de trayecto sigue el modelo log-distancia, con una sombra log-normal
+          propia de cada enlace (channelShadowing()).
+        - Un paquete se detecta si llega por encima de la sensibilidad de su SF
+          (piso de ruido + figura de ruido + SNR mínima del demodulador).
+        - Un paquete detectado se recibe si, para cada SF, su relación con la suma de las
+          potencias de los interferentes de ese SF supera el umbral de captureThreshold():
+          6 dB con el mismo SF y los umbrales negativos (casi ortogonalidad) medidos entre SF
+          distintos (Goursaud y Gorce, "Dedicated networks for IoT: PHY/MAC state of the art
+          and challenges", 2015).
+    Las potencias se expresan en dBm y los tiempos en us. No depende de Arduino.
+    @file channel_model.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef CHANNEL_MODEL_H
+#define CHANNEL_MODEL_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Radio (la configuración por defecto de la biblioteca LoRa, que el nodo no modifica).
+#define CHANNEL_BANDWIDTH 125000            // Ancho de banda (en Hz).
+#define CHANNEL_CODING_RATE 5               // Denominador de la tasa de código (4/5).
+#define CHANNEL_PREAMBLE 8                  // Símbolos de preámbulo.
+#define CHANNEL_CRC false                   // Si los paquetes llevan CRC (la biblioteca lo deshabilita por defecto).
+#define CHANNEL_SF_MIN 7                    // Menor SF.
+#define CHANNEL_SF_MAX 12                   // Mayor SF.
+#define CHANNEL_SFS (CHANNEL_SF_MAX - CHANNEL_SF_MIN + 1)
+
+/// Propagación en 433 MHz.
+#define CHANNEL_PATH_LOSS_1M 25.2           // Pérdida de espacio libre a 1 m (en dB).
+#define CHANNEL_PATH_LOSS_EXPONENT 3.0      // Exponente de la pérdida (entorno suburbano).
+#define CHANNEL_SHADOWING_SIGMA 6.0         // Desvío estándar de la sombra de cada enlace (en dB).
+#define CHANNEL_NOISE_FIGURE 6              // Figura de ruido del receptor (en dB).
+#define CHANNEL_THERMAL_NOISE -174          // Densidad de ruido térmico (en dBm/Hz).
+
+/**
+    channelAirtime() calcula el tiempo en el aire de un paquete, igual que LoRa.timeOnAir()
+    (Semtech SX1276/77/78/79, 4.1.1.7), con la optimización para bajas tasas que la biblioteca
+    activa cuando el símbolo dura más de 16 ms.
+    @param size Bytes de payload.
+    @param sf Factor de ensanchamiento.
+    @param implicitHeader Si se transmite sin header.
+    @return Tiempo en el aire (en us).
+*/
+inline uint32_t channelAirtime(size_t size, uint8_t sf, bool implicitHeader = false) {
+    double symbolDuration = (double)(1L << sf) * 1E6 / CHANNEL_BANDWIDTH;
+    bool ldo = symbolDuration > 16000;
+    long numerator = 8L * size - 4L * sf + 28 + (CHANNEL_CRC ? 16 : 0) - (implicitHeader ? 20 : 0);
+    long denominator = 4L * (sf - (ldo ? 2 : 0));
+    long payloadSymbols = 8;
+    if (numerator > 0) {
+        payloadSymbols += ((numerator + denominator - 1) / denominator) * CHANNEL_CODING_RATE;
+    }
+    return (uint32_t)((CHANNEL_PREAMBLE + 4.25 + payloadSymbols) * symbolDuration + 0.5);
+}
+
+/**
+    channelCadDuration() calcula la duración de un CAD: un símbolo más 32 chips de procesamiento.
+    @param sf Factor de ensanchamiento.
+    @return Duración (en us).
+*/
+inline uint32_t channelCadDuration(uint8_t sf) {
+    return (uint32_t)((double)((1L << sf) + 32) * 1E6 / CHANNEL_BANDWIDTH + 0.5);
+}
+
+/**
+    requiredSnr() obtiene la SNR mínima que demodula el SX1278 con un SF (igual que en adr_helpers.h).
+    @param sf Factor de ensanchamiento.
+    @return SNR mínima (en dB).
+*/
+inline double requiredSnr(uint8_t sf) {
+    return -7.5 - 2.5 * (sf - CHANNEL_SF_MIN);
+}
+
+/**
+    channelNoiseFloor() obtiene la potencia de ruido en el ancho de banda del canal.
+    @return Potencia de ruido (en dBm).
+*/
+inline double channelNoiseFloor() {
+    return CHANNEL_THERMAL_NOISE + 10 * log10((double)CHANNEL_BANDWIDTH) + CHANNEL_NOISE_FIGURE;
+}
+
+/**
+    channelSensitivity() obtiene la menor potencia que detecta (y demodula) el receptor con un SF.
+    @param sf Factor de ensanchamiento.
+    @return Sensibilidad (en dBm).
+*/
+inline double channelSensitivity(uint8_t sf) {
+    return channelNoiseFloor() + requiredSnr(sf);
+}
+
+/**
+    pathLoss() calcula la pérdida de trayecto media (sin sombra) a una distancia.
+    @param distance Distancia (en m, al menos 1 m).
+    @return Pérdida (en dB).
+*/
+inline double pathLoss(double distance) {
+    return CHANNEL_PATH_LOSS_1M + 10 * CHANNEL_PATH_LOSS_EXPONENT * log10(distance < 1 ? 1 : distance);
+}
+
+/**
+    pathLossRange() calcula la distancia a la que la pérdida media alcanza un valor (la inversa de pathLoss()).
+    @param loss Pérdida (en dB).
+    @return Distancia (en m).
+*/
+inline double pathLossRange(double loss) {
+    return pow(10, (loss - CHANNEL_PATH_LOSS_1M) / (10 * CHANNEL_PATH_LOSS_EXPONENT));
+}
+
+/**
+    channelShadowing() obtiene la sombra de un enlace, con distribución normal de desvío
+    CHANNEL_SHADOWING_SIGMA, a partir de dos números uniformes (Box-Muller).
+    @param u1 Número uniforme en (0, 1].
+    @param u2 Número uniforme en [0, 1).
+    @return Sombra (en dB).
+*/
+inline double channelShadowing(double u1, double u2) {
+    return CHANNEL_SHADOWING_SIGMA * sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+/**
+    captureThreshold() obtiene la relación señal/interferencia mínima para recibir un paquete
+    de un SF ante interferentes de otro (o del mismo) SF.
+    @param sf SF del paquete deseado.
+    @param interfererSf SF de los interferentes.
+    @return Umbral (en dB).
+*/
+inline double captureThreshold(uint8_t sf, uint8_t interfererSf) {
+    static const int8_t thresholds[CHANNEL_SFS][CHANNEL_SFS] = {
+        {   6, -16, -18, -19, -19, -20 },
+        { -24,   6, -20, -22, -22, -22 },
+        { -27, -27,   6, -23, -25, -25 },
+        { -30, -30, -30,   6, -26, -28 },
+        { -33, -33, -33, -33,   6, -29 },
+        { -36, -36, -36, -36, -36,   6 }
+    };
+    return thresholds[sf - CHANNEL_SF_MIN][interfererSf - CHANNEL_SF_MIN];
+}
+
+/**
+    Interference acumula la potencia de los interferentes de un paquete, separada por SF (en mW).
+    Por ejemplo:
+        Interference interference;
+        interference.add(7, -110);
+        bool received = interference.captured(-100, 7);
+*/
+struct Interference {
+    double power[CHANNEL_SFS] = {0};
+
+    /**
+        add() suma un interferente.
+        @param sf SF del interferente.
+        @param dbm Potencia con que llega (en dBm).
+    */
+    void add(uint8_t sf, double dbm) {
+        power[sf - CHANNEL_SF_MIN] += pow(10, dbm / 10);
+    }
+
+    /**
+        captured() determina si un paquete se recibe a pesar de los interferentes acumulados.
+        @param dbm Potencia con que llega el paquete (en dBm, ya por encima de la sensibilidad).
+        @param sf SF del paquete.
+        @return true si supera el umbral de captura ante cada SF.
+    */
+    bool captured(double dbm, uint8_t sf) const {
+        for (uint8_t i = 0; i < CHANNEL_SFS; i++) {
+            if (power[i] > 0 && dbm - 10 * log10(power[i]) < captureThreshold(sf, CHANNEL_SF_MIN + i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,868 @@
+/**
+    Programa que estima cuántos nodos soporta un único concentrador de 433 MHz: simula por
+    eventos discretos una flota de nodos que comparten el canal (ver channel_model.h) y mide la
+    entrega de los reportes, su latencia y el uso del ciclo de trabajo a medida que crece la flota.
+    Cada nodo ejecuta la misma lógica que el firmware con la configuración de constants.h:
+        - compone un reporte cada TIMEOUT_LORA segundos según runEvery() (el período se corre con
+          la demora del loop() y con la deriva del reloj de cada nodo), con composeBinaryReport()
+          (reportes diferenciales y empaquetados con los encoders reales de report_helpers.h y
+          report_fields.h) y con valores de sensores sintéticos,
+        - lo descarta si excede el ciclo de trabajo (las ventanas móviles de airtime_helpers.h),
+        - lo encola y lo transmite como LoRa.cpp: con LORA_LISTEN_BEFORE_TALK hace un CAD y,
+          si el canal está ocupado, espera de 1 a 2^(intentos + 1) veces su tiempo en el aire,
+          hasta LORA_LBT_MAX_ATTEMPTS intentos, y
+        - toma como referencia el reporte que le reconoce el concentrador (acknowledgeReport()).
+    El concentrador es un SX1278 con el mismo SF: demodula un paquete a la vez (el primero que
+    detecta), no escucha mientras hace un CAD o transmite, decodifica con ReportDecoder
+    (ver report_decoder.h) y responde cada reporte con su "ack" por el mismo camino que los nodos.
+    Un nodo recibe el "ack" si estaba escuchando (sin transmitir, sin hacer un CAD y sin estar
+    recibiendo el paquete de otro nodo) y el "ack" supera la captura.
+    Con LORA_FREQUENCY_HOPPING, cada reporte sale en el canal de channel_plan.h que le corresponde
+    y el concentrador escucha en todos los canales (un receptor por canal); los "ack" se transmiten
+    en el primer canal (LORA_FREQ), en el que escuchan los nodos.
+    No se simulan LORA_ADR, LORA_CONFIRMED_REPORT, LORA_BATCH_REPORT, LORA_SERIES_REPORT,
+    LORA_EXCEPTION_REPORT ni LORA_TDMA (se ignoran aunque estén definidos en constants.h).
+    Los enlaces con el concentrador tienen sombra; los enlaces entre nodos (que deciden el CAD
+    y la interferencia en la recepción de los "ack") sólo dependen de la distancia.
+    Para compilarlo y ejecutarlo:
+        g++ -std=c++11 -O2 fleet_simulator.cpp -o fleet_simulator
+        ./fleet_simulator [horas] [cantidades de nodos...]
+    (por defecto, un día con 10, 100, 1000 y 10000 nodos). Para simular el salto de frecuencia
+    sin modificar constants.h, compilarlo con -DLORA_FREQUENCY_HOPPING.
+    @file fleet_simulator.cpp
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "../nodo-sisicic/constants.h"
+#include "../nodo-sisicic/channel_plan.h"
+#include "../concentrador/report_decoder.h"
+#include "channel_model.h"
+
+#ifndef LORA_BINARY_REPORT
+    #error "El simulador modela el reporte binario (LORA_BINARY_REPORT)"
+#endif
+
+/// Flota.
+#define SIM_HOURS 24                        // Duración simulada por defecto (en horas).
+#define SIM_RADIUS 4000                     // Radio del área, con el concentrador en el centro (en m).
+#define SIM_TX_POWER 17                     // Potencia de nodos y concentrador (en dBm, la de la biblioteca).
+#define SIM_SF 7                            // SF de nodos y concentrador (el de la biblioteca).
+#define SIM_CLOCK_PPM 100                   // Máxima deriva del reloj de cada nodo (en ppm).
+#define SIM_LOOP_JITTER 50                  // Máxima demora del loop() en atender runEvery() (en ms).
+#define SIM_FIRST_DEVICE_ID 20000           // DEVICE_ID del primer nodo.
+#define SIM_LBT_MAX_ATTEMPTS 4              // Igual que LORA_LBT_MAX_ATTEMPTS (LoRa.h).
+#define SIM_TX_QUEUE_SIZE 128               // Bytes de la cola de transmisión (LORA_TX_QUEUE_SIZE en un ATmega328).
+#define SIM_TX_ENTRY_HEADER 7               // Bytes que ocupa cada paquete además de su largo (LORA_TX_ENTRY_HEADER).
+#define SIM_GATEWAY_DUTY_CYCLE DUTY_CYCLE_PERCENT   // Ciclo de trabajo del concentrador (en %, 0 para no limitarlo).
+#define SIM_MAX_PAYLOAD 64                  // Mayor paquete que se transmite (en bytes).
+#define SIM_LATENCY_MAX 600000              // Mayor latencia del histograma (en ms, las mayores se acumulan ahí).
+#define SIM_DEAF_HISTORY 4                  // Intervalos sin escuchar (CAD o transmisión) que se recuerdan por estación.
+#define SIM_GPS_JITTER 30                   // Ruido de la posición de los nodos (en 1e-7 grados, menor que la mitad de la resolución del paquete).
+#define SIM_SEED 20009                      // Semilla del generador.
+
+/// Canales en que transmiten los nodos (ver channel_plan.h).
+#ifdef LORA_FREQUENCY_HOPPING
+    #define SIM_CHANNELS LORA_CHANNELS
+#else
+    #define SIM_CHANNELS 1
+#endif
+
+/// Coordenadas del concentrador (en 1e-7 grados y m).
+#define SIM_GATEWAY_LAT -346037000L
+#define SIM_GATEWAY_LNG -583816000L
+#define SIM_GATEWAY_ALT 25
+
+/**
+    Packet contiene un paquete de la cola de transmisión de una estación:
+        - data, length: contenido.
+        - seq: seq del reporte (o el seq reconocido, en un "ack").
+        - channel: índice del canal en channelPlan.
+        - target: nodo destinatario (sólo en los "ack").
+        - composedAt: instante en que se compuso (en us).
+*/
+struct Packet {
+    uint8_t data[SIM_MAX_PAYLOAD];
+    uint8_t length;
+    uint8_t seq;
+    uint8_t channel;
+    uint32_t target;
+    uint64_t composedAt;
+};
+
+/**
+    Transmission contiene un paquete en el aire:
+        - id: número de la transmisión (consecutivo, desde 1).
+        - sender: estación que lo transmite.
+        - start, end: comienzo y fin (en us).
+        - packet: contenido.
+*/
+struct Transmission {
+    uint64_t id;
+    uint32_t sender;
+    uint64_t start;
+    uint64_t end;
+    Packet packet;
+};
+
+/**
+    Station contiene el estado de un nodo (o del concentrador):
+        - x, y: posición (en m).
+        - gatewayLoss: pérdida del enlace con el concentrador, con su sombra (en dB).
+        - nextReport, period: próximo reporte y período nominal de runEvery() en su reloj (en us).
+        - outcomingReport, referenceReport, referenceValid, reportsSinceKeyframe: como en el firmware.
+        - airtimeBuckets, airtimeBucket, airtimeBucketStart, budget: ventana móvil del
+          ciclo de trabajo (en ms), como en airtime_helpers.h (budget 0 para no limitarla).
+        - queue, txBusy, lbtAttempts, cadStart, currentTx: cola de transmisión y LBT, como en LoRa.cpp.
+        - deafStart, deafEnd, deafNext: últimos intervalos sin escuchar (en us).
+        - airtime: tiempo en el aire total (en us).
+        - peakAirtime: mayor ocupación de la ventana del ciclo de trabajo (en ms).
+*/
+struct Station {
+    double x;
+    double y;
+    double gatewayLoss;
+    uint64_t nextReport;
+    uint64_t period;
+    int32_t lat;                    // Posición real (en 1e-7 grados, múltiplo de 1e-5), a la que el GPS suma ruido.
+    int32_t lng;
+    Report outcomingReport;
+    Report referenceReport;
+    bool referenceValid;
+    uint8_t reportsSinceKeyframe;
+    uint32_t airtimeBuckets[DUTY_CYCLE_BUCKETS];
+    uint8_t airtimeBucket;
+    uint64_t airtimeBucketStart;
+    uint32_t budget;
+    std::deque<Packet> queue;
+    size_t queuedBytes;
+    bool txBusy;
+    uint8_t lbtAttempts;
+    uint64_t cadStart;
+    uint64_t currentTx;
+    uint64_t deafStart[SIM_DEAF_HISTORY];
+    uint64_t deafEnd[SIM_DEAF_HISTORY];
+    uint8_t deafNext;
+    uint64_t airtime;
+    uint32_t peakAirtime;
+};
+
+/**
+    EventType indica qué ocurre en un evento de una estación.
+*/
+enum EventType {
+    EVENT_REPORT,       // runEvery() del reporte (sólo nodos).
+    EVENT_CAD_DONE,     // Fin del CAD.
+    EVENT_RETRY,        // Fin de la espera aleatoria del LBT.
+    EVENT_TX_DONE       // Fin de la transmisión.
+};
+
+/**
+    Event contiene un evento pendiente, ordenado por instante (y por orden de creación si coinciden).
+*/
+struct Event {
+    uint64_t time;
+    uint64_t order;
+    uint32_t station;
+    uint8_t type;
+
+    bool operator>(const Event& other) const {
+        return time != other.time ? time > other.time : order > other.order;
+    }
+};
+
+/**
+    FleetStats contiene los resultados de una simulación (los tiempos en us).
+*/
+struct FleetStats {
+    unsigned nodes;
+    unsigned channels;              // Canales en que transmiten los nodos.
+    double hours;
+    double seconds;                 // Tiempo real que llevó simularla (en s).
+    uint64_t events;
+    uint64_t composed;              // Reportes compuestos.
+    uint64_t deltaReports;          // De ellos, diferenciales.
+    uint64_t positionDeltas;        // Diferenciales con cambio de posición (los nodos están quietos).
+    uint64_t dutyCycleDropped;      // Descartados por el ciclo de trabajo.
+    uint64_t queueDropped;          // Descartados por cola de transmisión llena.
+    uint64_t transmitted;
+    uint64_t delivered;             // Decodificados por el concentrador.
+    uint64_t lostSensitivity;       // Llegaron por debajo de la sensibilidad.
+    uint64_t lostGatewayBusy;       // El concentrador recibía otro paquete, transmitía o hacía un CAD.
+    uint64_t lostCollision;         // No superaron la captura.
+    uint64_t lostReference;         // Diferenciales cuya referencia el concentrador no recuerda.
+    uint64_t lostMalformed;
+    uint64_t cads;
+    uint64_t channelBusy;           // CAD que encontraron el canal ocupado.
+    uint64_t acksSent;
+    uint64_t acksDropped;           // Descartados por el ciclo de trabajo o la cola del concentrador.
+    uint64_t acksReceived;
+    uint64_t acksLostDeaf;          // El nodo transmitía, hacía un CAD o recibía a otro nodo.
+    uint64_t uplinkAirtime;
+    uint64_t gatewayAirtime;
+    double meanDutyCycle;           // Promedio por nodo (en %).
+    double maxDutyCycle;            // Del nodo que más transmitió (en %).
+    double peakBudget;              // Mayor ocupación de una ventana del ciclo de trabajo (en % de AIRTIME_BUDGET).
+    uint64_t latencyP50;            // Percentiles de la latencia de los reportes entregados (en ms).
+    uint64_t latencyP90;
+    uint64_t latencyP99;
+    uint64_t latencyMax;
+};
+
+/**
+    nextRandom() genera un número pseudoaleatorio (xorshift32), para que cada ejecución sea igual.
+    @param &state Estado del generador (distinto de 0).
+    @return Siguiente número.
+*/
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+    uniform() genera un número pseudoaleatorio uniforme en (0, 1).
+    @param &state Estado del generador.
+    @return Siguiente número.
+*/
+static double uniform(uint32_t& state) {
+    return (nextRandom(state) + 0.5) / 4294967296.0;
+}
+
+/**
+    FleetSimulator simula una flota de nodos y su concentrador durante un tiempo dado.
+    Por ejemplo:
+        FleetSimulator simulator(1000, SIM_SEED);
+        FleetStats stats = simulator.run(24);
+*/
+class FleetSimulator {
+public:
+    /**
+        Constructor: ubica los nodos al azar en el área (uniformes en el círculo de radio SIM_RADIUS)
+        y al concentrador (la última estación) en el centro.
+        @param nodes Cantidad de nodos.
+        @param seed Semilla del generador.
+    */
+    FleetSimulator(unsigned nodes, uint32_t seed) : nodes(nodes), stations(nodes + 1), randomState(seed) {
+        detectionLoss = SIM_TX_POWER - channelSensitivity(SIM_SF);
+        double range = pathLossRange(detectionLoss);
+        detectionRange2 = range * range;
+        for (unsigned i = 0; i <= nodes; i++) {
+            Station& station = stations[i];
+            if (i == nodes) {
+                station.budget = SIM_GATEWAY_DUTY_CYCLE * DUTY_CYCLE_WINDOW * 10UL;
+                continue;
+            }
+            double r = SIM_RADIUS * sqrt(uniform(randomState));
+            double angle = 2 * M_PI * uniform(randomState);
+            station.x = r * cos(angle);
+            station.y = r * sin(angle);
+            station.gatewayLoss = pathLoss(r) + channelShadowing(uniform(randomState), uniform(randomState));
+            station.budget = AIRTIME_BUDGET;
+
+            double skew = SIM_CLOCK_PPM * (2 * uniform(randomState) - 1) / 1E6;
+            station.period = (uint64_t)(TIMEOUT_LORA * 1E6 * (1 + skew));
+            station.nextReport = (uint64_t)(station.period * uniform(randomState));
+
+            Report& report = station.outcomingReport;
+            report.deviceId = SIM_FIRST_DEVICE_ID + i;
+            report.seq = nextRandom(randomState);
+            report.current = nextRandom(randomState) % 2000;
+            report.raindrops = -1;
+            report.gas = 500 + nextRandom(randomState) % 1000;
+            station.lat = (SIM_GATEWAY_LAT + (int32_t)(station.y / 111320 * 1E7)) / 100 * 100;
+            station.lng = (SIM_GATEWAY_LNG + (int32_t)(station.x / (111320 * 0.823) * 1E7)) / 100 * 100;
+            report.alt = SIM_GATEWAY_ALT + nextRandom(randomState) % 20;
+        }
+    }
+
+    /**
+        run() simula la flota.
+        @param hours Tiempo a simular (en horas).
+        @return Resultados.
+    */
+    FleetStats run(double hours) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        duration = (uint64_t)(hours * 3600E6);
+        stats = FleetStats();
+        stats.nodes = nodes;
+        stats.channels = SIM_CHANNELS;
+        stats.hours = hours;
+        latencies.assign(SIM_LATENCY_MAX + 1, 0);
+
+        for (unsigned i = 0; i < nodes; i++) {
+            schedule(stations[i].nextReport, i, EVENT_REPORT);
+        }
+        while (!events.empty() && events.top().time < duration) {
+            Event event = events.top();
+            events.pop();
+            stats.events++;
+            switch (event.type) {
+                case EVENT_REPORT:
+                    reportDue(event.station, event.time);
+                    break;
+                case EVENT_CAD_DONE:
+                    cadDone(event.station, event.time);
+                    break;
+                case EVENT_RETRY:
+                    transmitQueued(event.station, event.time);
+                    break;
+                case EVENT_TX_DONE:
+                    txDone(event.station, event.time);
+                    break;
+            }
+        }
+
+        summarize();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return stats;
+    }
+
+private:
+    unsigned nodes;
+    std::vector<Station> stations;
+    uint32_t randomState;
+    double detectionLoss;
+    double detectionRange2;
+    uint64_t duration;
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event> > events;
+    uint64_t eventOrder = 0;
+    std::deque<Transmission> air;
+    uint64_t nextTx = 1;
+    uint32_t maxAirtime = 0;
+    uint64_t gatewayLock[LORA_CHANNELS] = {0};
+    ReportDecoder decoder;
+
+    FleetStats stats;
+    std::vector<uint64_t> latencies;
+
+    bool isGateway(uint32_t station) const {
+        return station == nodes;
+    }
+
+    void schedule(uint64_t time, uint32_t station, uint8_t type) {
+        Event event = { time, eventOrder++, station, type };
+        events.push(event);
+    }
+
+    /**
+        reportDue() compone y envía el reporte de un nodo (transmitCurrentReport() y sendLoRaPacket()),
+        y agenda el siguiente: como runEvery() toma el instante en que se atendió, la demora
+        del loop() se acumula en el período.
+    */
+    void reportDue(uint32_t index, uint64_t now) {
+        Station& node = stations[index];
+        uint64_t jitter = (uint64_t)(SIM_LOOP_JITTER * 1000 * uniform(randomState));
+        schedule(now + node.period + jitter, index, EVENT_REPORT);
+
+        Packet packet;
+        packet.length = composeBinaryReport(node, packet.data, now);
+        packet.seq = node.outcomingReport.seq;
+        #ifdef LORA_FREQUENCY_HOPPING
+            packet.channel = hopChannel(node.outcomingReport.deviceId, packet.seq);
+        #else
+            packet.channel = 0;
+        #endif
+        packet.target = 0;
+        packet.composedAt = now;
+        stats.composed++;
+        if (packet.data[0] == reportHeader(REPORT_TYPE_DELTA)) {
+            stats.deltaReports++;
+        }
+        if (!send(index, packet, now)) {
+            return;
+        }
+        stats.transmitted++;
+    }
+
+    /**
+        composeBinaryReport() es la del firmware (ver LoRa_helpers.h), con los sensores
+        de fillSensors().
+    */
+    size_t composeBinaryReport(Station& node, uint8_t buf[], uint64_t now) {
+        Report& report = node.outcomingReport;
+        fillSensors(node, now);
+        report.seq++;
+        #ifdef LORA_PACKED_REPORT
+            quantizePackedReport(report);
+        #endif
+
+        #ifdef LORA_DELTA_REPORT
+            uint8_t referenceAge = report.seq - node.referenceReport.seq;
+            if (node.referenceValid && referenceAge < REPORT_REFERENCE_HISTORY
+                    && node.reportsSinceKeyframe < DELTA_KEYFRAME_INTERVAL) {
+                node.reportsSinceKeyframe++;
+                if (report.lat != node.referenceReport.lat || report.lng != node.referenceReport.lng) {
+                    stats.positionDeltas++;
+                }
+                return encodeDeltaReport(report, node.referenceReport, buf);
+            }
+            node.reportsSinceKeyframe = 0;
+        #endif
+
+        #ifdef LORA_PACKED_REPORT
+            return encodePackedReport(report, buf);
+        #else
+            return encodeReport(report, buf);
+        #endif
+    }
+
+    /**
+        fillSensors() actualiza los sensores sintéticos de un nodo: la corriente varía al azar,
+        el combustible baja de a poco (y se recarga al vaciarse), la lluvia cambia rara vez
+        y la posición es fija, con el ruido del GPS.
+    */
+    void fillSensors(Station& node, uint64_t now) {
+        Report& report = node.outcomingReport;
+        int32_t current = report.current + (int32_t)(nextRandom(randomState) % 61) - 30;
+        report.current = constrainValue(current, 0, 16383);
+        int32_t gas = report.gas - (int32_t)(nextRandom(randomState) % 3);
+        report.gas = gas < 0 ? 1500 : gas;
+        if (nextRandom(randomState) % 200 == 0) {
+            report.raindrops = (int8_t)(nextRandom(randomState) % 3) - 1;
+        }
+        report.lat = node.lat + (int32_t)(nextRandom(randomState) % (2 * SIM_GPS_JITTER + 1)) - SIM_GPS_JITTER;
+        report.lng = node.lng + (int32_t)(nextRandom(randomState) % (2 * SIM_GPS_JITTER + 1)) - SIM_GPS_JITTER;
+        report.airtime = consumedAirtime(node, now) / 100;
+    }
+
+    static int32_t constrainValue(int32_t value, int32_t low, int32_t high) {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    /**
+        rotateAirtimeBuckets(), consumedAirtime() y accountAirtime() son las de airtime_helpers.h,
+        con el reloj de la simulación.
+    */
+    void rotateAirtimeBuckets(Station& station, uint64_t nowMs) {
+        const uint64_t bucketLength = DUTY_CYCLE_WINDOW * 1000UL / DUTY_CYCLE_BUCKETS;
+        for (int i = 0; i < DUTY_CYCLE_BUCKETS && nowMs - station.airtimeBucketStart >= bucketLength; i++) {
+            station.airtimeBucket = (station.airtimeBucket + 1) % DUTY_CYCLE_BUCKETS;
+            station.airtimeBuckets[station.airtimeBucket] = 0;
+            station.airtimeBucketStart += bucketLength;
+        }
+        if (nowMs - station.airtimeBucketStart >= bucketLength) {
+            station.airtimeBucketStart = nowMs;
+        }
+    }
+
+    uint32_t consumedAirtime(Station& station, uint64_t now) {
+        rotateAirtimeBuckets(station, now / 1000);
+        uint32_t total = 0;
+        for (int i = 0; i < DUTY_CYCLE_BUCKETS; i++) {
+            total += station.airtimeBuckets[i];
+        }
+        return total;
+    }
+
+    static uint32_t packetAirtime(size_t length) {
+        return (channelAirtime(length, SIM_SF) + 999) / 1000;
+    }
+
+    /**
+        send() es sendLoRaPacket() (y LoRa.enqueuePacket()): descarta el paquete si excede el
+        ciclo de trabajo o si la cola está llena y, si no, lo encola y empieza a transmitir
+        si la estación no estaba transmitiendo.
+        @return true si el paquete quedó encolado.
+    */
+    bool send(uint32_t index, const Packet& packet, uint64_t now) {
+        Station& station = stations[index];
+        uint32_t consumed = consumedAirtime(station, now);
+        uint32_t airtime = packetAirtime(packet.length);
+        if (station.budget > 0 && consumed + airtime > station.budget) {
+            if (isGateway(index)) {
+                stats.acksDropped++;
+            } else {
+                stats.dutyCycleDropped++;
+            }
+            return false;
+        }
+        if (station.queuedBytes + SIM_TX_ENTRY_HEADER + packet.length > SIM_TX_QUEUE_SIZE) {
+            if (isGateway(index)) {
+                stats.acksDropped++;
+            } else {
+                stats.queueDropped++;
+            }
+            return false;
+        }
+        station.airtimeBuckets[station.airtimeBucket] += airtime;
+        station.peakAirtime = std::max(station.peakAirtime, consumed + airtime);
+        station.queue.push_back(packet);
+        station.queuedBytes += SIM_TX_ENTRY_HEADER + packet.length;
+        if (!station.txBusy) {
+            transmitQueued(index, now);
+        }
+        return true;
+    }
+
+    /**
+        transmitQueued() es la de LoRa.cpp: deja de escuchar y, con LBT, hace un CAD antes de
+        transmitir el primer paquete de la cola (salvo que ya haya agotado los intentos).
+    */
+    void transmitQueued(uint32_t index, uint64_t now) {
+        Station& station = stations[index];
+        station.txBusy = true;
+        if (isGateway(index)) {
+            gatewayLock[0] = 0;
+        }
+        #ifdef LORA_LISTEN_BEFORE_TALK
+            if (station.lbtAttempts < SIM_LBT_MAX_ATTEMPTS) {
+                uint64_t end = now + channelCadDuration(SIM_SF);
+                station.cadStart = now;
+                setDeaf(station, now, end);
+                stats.cads++;
+                schedule(end, index, EVENT_CAD_DONE);
+                return;
+            }
+        #endif
+        startQueued(index, now);
+    }
+
+    /**
+        cadDone() transmite el paquete si el canal está libre y, si no, vuelve a escuchar
+        y espera un tiempo aleatorio (backoffQueued() de LoRa.cpp).
+    */
+    void cadDone(uint32_t index, uint64_t now) {
+        Station& station = stations[index];
+        if (!channelActive(index, station.cadStart, now)) {
+            startQueued(index, now);
+            return;
+        }
+        station.lbtAttempts++;
+        stats.channelBusy++;
+        uint64_t slot = channelAirtime(station.queue.front().length, SIM_SF) / 1000 + 1;
+        uint8_t window = 2 << station.lbtAttempts;
+        schedule(now + (1 + nextRandom(randomState) % window) * slot * 1000, index, EVENT_RETRY);
+    }
+
+    /**
+        startQueued() pone en el aire el primer paquete de la cola. Si lo transmite un nodo
+        y el receptor de su canal en el concentrador está escuchando sin haber detectado otro
+        paquete, lo detecta si llega por encima de la sensibilidad.
+    */
+    void startQueued(uint32_t index, uint64_t now) {
+        Station& station = stations[index];
+        station.lbtAttempts = 0;
+
+        Transmission tx;
+        tx.id = nextTx++;
+        tx.sender = index;
+        tx.start = now;
+        uint32_t airtime = channelAirtime(station.queue.front().length, SIM_SF);
+        tx.end = now + airtime;
+        tx.packet = station.queue.front();
+        station.queuedBytes -= SIM_TX_ENTRY_HEADER + tx.packet.length;
+        station.queue.pop_front();
+
+        while (!air.empty() && air.front().end + maxAirtime < now) {
+            air.pop_front();
+        }
+        air.push_back(tx);
+        maxAirtime = std::max(maxAirtime, airtime);
+
+        station.currentTx = tx.id;
+        station.airtime += airtime;
+        setDeaf(station, now, tx.end);
+        if (isGateway(index)) {
+            stats.gatewayAirtime += airtime;
+        } else {
+            stats.uplinkAirtime += airtime;
+            uint8_t channel = tx.packet.channel;
+            bool gatewayListening = channel != 0 || listening(stations[nodes], now);
+            if (gatewayLock[channel] == 0 && gatewayListening && station.gatewayLoss <= detectionLoss) {
+                gatewayLock[channel] = tx.id;
+            }
+        }
+        schedule(tx.end, index, EVENT_TX_DONE);
+    }
+
+    /**
+        txDone() resuelve la recepción del paquete que terminó y sigue con la cola
+        (o vuelve a escuchar), como el ISR de TxDone.
+    */
+    void txDone(uint32_t index, uint64_t now) {
+        Station& station = stations[index];
+        const Transmission& tx = air[station.currentTx - air.front().id];
+        if (isGateway(index)) {
+            ackDone(tx);
+        } else {
+            uplinkDone(tx, now);
+        }
+        if (!station.queue.empty()) {
+            transmitQueued(index, now);
+        } else {
+            station.txBusy = false;
+        }
+    }
+
+    /**
+        uplinkDone() resuelve la recepción de un reporte en el concentrador y, si lo decodifica,
+        le responde con su "ack".
+    */
+    void uplinkDone(const Transmission& tx, uint64_t now) {
+        const Station& node = stations[tx.sender];
+        if (node.gatewayLoss > detectionLoss) {
+            stats.lostSensitivity++;
+            return;
+        }
+        if (gatewayLock[tx.packet.channel] != tx.id) {
+            stats.lostGatewayBusy++;
+            return;
+        }
+        gatewayLock[tx.packet.channel] = 0;
+
+        Interference interference;
+        forEachOverlapping(tx.packet.channel, tx.start, tx.end, [&](const Transmission& other) {
+            if (other.id != tx.id && !isGateway(other.sender)) {
+                interference.add(SIM_SF, SIM_TX_POWER - stations[other.sender].gatewayLoss);
+            }
+        });
+        if (!interference.captured(SIM_TX_POWER - node.gatewayLoss, SIM_SF)) {
+            stats.lostCollision++;
+            return;
+        }
+
+        Report report;
+        DecodeStatus status = decoder.decode(tx.packet.data, tx.packet.length, report);
+        if (status == DECODE_MISSING_REFERENCE) {
+            stats.lostReference++;
+            return;
+        }
+        if (status != DECODE_OK) {
+            stats.lostMalformed++;
+            return;
+        }
+        stats.delivered++;
+        uint64_t latency = (now - tx.packet.composedAt) / 1000;
+        latencies[std::min<uint64_t>(latency, SIM_LATENCY_MAX)]++;
+        stats.latencyMax = std::max(stats.latencyMax, latency);
+
+        std::string command = ReportDecoder::ackCommand(report, SIM_TX_POWER - node.gatewayLoss - channelNoiseFloor());
+        Packet ack;
+        ack.length = command.size();
+        memcpy(ack.data, command.data(), ack.length);
+        ack.seq = report.seq;
+        ack.channel = 0;
+        ack.target = tx.sender;
+        ack.composedAt = now;
+        if (send(nodes, ack, now)) {
+            stats.acksSent++;
+        }
+    }
+
+    /**
+        ackDone() resuelve la recepción de un "ack" en su nodo y, si lo recibe, lo procesa
+        (acknowledgeReport()).
+    */
+    void ackDone(const Transmission& tx) {
+        Station& node = stations[tx.packet.target];
+        if (node.gatewayLoss > detectionLoss) {
+            return;
+        }
+        bool deaf = !listening(node, tx.start, tx.end);
+        Interference interference;
+        forEachOverlapping(0, tx.start, tx.end, [&](const Transmission& other) {
+            if (other.id == tx.id || other.sender == tx.packet.target) {
+                return;
+            }
+            double distance2 = squaredDistance(stations[other.sender], node);
+            // El nodo quedó demodulando el paquete de otro nodo que empezó antes.
+            if (other.start <= tx.start && distance2 <= detectionRange2) {
+                deaf = true;
+            }
+            interference.add(SIM_SF, SIM_TX_POWER - pathLoss(sqrt(distance2)));
+        });
+        if (deaf) {
+            stats.acksLostDeaf++;
+            return;
+        }
+        if (!interference.captured(SIM_TX_POWER - node.gatewayLoss, SIM_SF)) {
+            return;
+        }
+        stats.acksReceived++;
+        if (tx.packet.seq == node.outcomingReport.seq) {
+            node.referenceReport = node.outcomingReport;
+            node.referenceValid = true;
+        }
+    }
+
+    /**
+        channelActive() determina si el CAD de una estación detecta algún paquete en el aire,
+        en el canal del paquete que va a transmitir.
+    */
+    bool channelActive(uint32_t index, uint64_t start, uint64_t end) {
+        const Station& station = stations[index];
+        bool active = false;
+        forEachOverlapping(station.queue.front().channel, start, end, [&](const Transmission& other) {
+            if (active || other.sender == index) {
+                return;
+            }
+            if (isGateway(index)) {
+                active = stations[other.sender].gatewayLoss <= detectionLoss;
+            } else if (isGateway(other.sender)) {
+                active = station.gatewayLoss <= detectionLoss;
+            } else {
+                active = squaredDistance(stations[other.sender], station) <= detectionRange2;
+            }
+        });
+        return active;
+    }
+
+    /**
+        forEachOverlapping() recorre los paquetes en el aire de un canal que se superponen con un intervalo.
+    */
+    template<typename F>
+    void forEachOverlapping(uint8_t channel, uint64_t start, uint64_t end, F f) {
+        for (size_t i = air.size(); i > 0; i--) {
+            const Transmission& other = air[i - 1];
+            if (other.start + maxAirtime <= start) {
+                break;
+            }
+            if (other.packet.channel == channel && other.start < end && other.end > start) {
+                f(other);
+            }
+        }
+    }
+
+    static double squaredDistance(const Station& a, const Station& b) {
+        double dx = a.x - b.x;
+        double dy = a.y - b.y;
+        return dx * dx + dy * dy;
+    }
+
+    void setDeaf(Station& station, uint64_t start, uint64_t end) {
+        station.deafStart[station.deafNext] = start;
+        station.deafEnd[station.deafNext] = end;
+        station.deafNext = (station.deafNext + 1) % SIM_DEAF_HISTORY;
+    }
+
+    /**
+        listening() determina si una estación escuchó (sin hacer un CAD ni transmitir)
+        durante todo un intervalo.
+    */
+    bool listening(const Station& station, uint64_t start, uint64_t end) const {
+        for (int i = 0; i < SIM_DEAF_HISTORY; i++) {
+            if (station.deafStart[i] < end && station.deafEnd[i] > start) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool listening(const Station& station, uint64_t now) const {
+        return listening(station, now, now + 1);
+    }
+
+    /**
+        summarize() calcula los percentiles de latencia y el uso del ciclo de trabajo.
+    */
+    void summarize() {
+        uint64_t total = 0;
+        uint64_t p50 = stats.delivered / 2;
+        uint64_t p90 = stats.delivered * 9 / 10;
+        uint64_t p99 = stats.delivered * 99 / 100;
+        for (size_t ms = 0; ms < latencies.size() && stats.delivered > 0; ms++) {
+            if (total <= p50 && total + latencies[ms] > p50) {
+                stats.latencyP50 = ms;
+            }
+            if (total <= p90 && total + latencies[ms] > p90) {
+                stats.latencyP90 = ms;
+            }
+            if (total <= p99 && total + latencies[ms] > p99) {
+                stats.latencyP99 = ms;
+            }
+            total += latencies[ms];
+        }
+
+        uint32_t peak = 0;
+        double sum = 0;
+        for (unsigned i = 0; i < nodes; i++) {
+            double dutyCycle = 100.0 * stations[i].airtime / duration;
+            sum += dutyCycle;
+            stats.maxDutyCycle = std::max(stats.maxDutyCycle, dutyCycle);
+            peak = std::max(peak, stations[i].peakAirtime);
+        }
+        stats.meanDutyCycle = nodes > 0 ? sum / nodes : 0;
+        stats.peakBudget = 100.0 * peak / AIRTIME_BUDGET;
+    }
+};
+
+/**
+    percent() calcula un porcentaje, sin dividir por cero.
+*/
+static double percent(uint64_t part, uint64_t total) {
+    return total > 0 ? 100.0 * part / total : 0;
+}
+
+/**
+    printStats() imprime los resultados de una simulación.
+    @param stats Resultados.
+*/
+static void printStats(const FleetStats& stats) {
+    double airtime = stats.hours * 3600E6;
+    printf("%u nodos, %.1f h (%.1f s, %.1f millones de eventos por segundo):\n",
+           stats.nodes, stats.hours, stats.seconds, stats.events / stats.seconds / 1E6);
+    printf("  Reportes: %llu compuestos (%.1f %% diferenciales, %.1f %% de ellos con cambio de posición), %llu descartados por ciclo de trabajo, %llu por cola llena\n",
+           (unsigned long long)stats.composed, percent(stats.deltaReports, stats.composed),
+           percent(stats.positionDeltas, stats.deltaReports),
+           (unsigned long long)stats.dutyCycleDropped, (unsigned long long)stats.queueDropped);
+    printf("  Entrega: %.2f %% (pérdidas: sensibilidad %.2f %%, concentrador ocupado %.2f %%, colisión %.2f %%, sin referencia %.2f %%)\n",
+           percent(stats.delivered, stats.composed), percent(stats.lostSensitivity, stats.composed),
+           percent(stats.lostGatewayBusy, stats.composed), percent(stats.lostCollision, stats.composed),
+           percent(stats.lostReference, stats.composed));
+    printf("  Latencia (ms): p50 %llu, p90 %llu, p99 %llu, máxima %llu\n",
+           (unsigned long long)stats.latencyP50, (unsigned long long)stats.latencyP90,
+           (unsigned long long)stats.latencyP99, (unsigned long long)stats.latencyMax);
+    printf("  Canales: reportes en el aire el %.2f %% del tiempo de cada canal (sumados), acks el %.2f %%; %.2f %% de los CAD lo encontraron ocupado\n",
+           100.0 * stats.uplinkAirtime / airtime / stats.channels, 100.0 * stats.gatewayAirtime / airtime,
+           percent(stats.channelBusy, stats.cads));
+    printf("  Ciclo de trabajo de los nodos: medio %.3f %%, máximo %.3f %% (pico de ventana %.1f %% del presupuesto)\n",
+           stats.meanDutyCycle, stats.maxDutyCycle, stats.peakBudget);
+    printf("  Acks: %llu enviados, %llu descartados por el concentrador (ciclo de trabajo o cola llena), %llu recibidos (%llu con el nodo sordo)\n",
+           (unsigned long long)stats.acksSent, (unsigned long long)stats.acksDropped,
+           (unsigned long long)stats.acksReceived, (unsigned long long)stats.acksLostDeaf);
+}
+
+int main(int argc, char* argv[]) {
+    double hours = argc > 1 ? atof(argv[1]) : SIM_HOURS;
+    std::vector<unsigned> fleets;
+    for (int i = 2; i < argc; i++) {
+        fleets.push_back(atoi(argv[i]));
+    }
+    if (fleets.empty()) {
+        fleets = { 10, 100, 1000, 10000 };
+    }
+
+    printf("SF%d, %d dBm, radio de %d m, un reporte cada %d s por nodo, %u canales\n",
+           SIM_SF, SIM_TX_POWER, SIM_RADIUS, TIMEOUT_LORA, (unsigned)SIM_CHANNELS);
+    std::vector<FleetStats> results;
+    for (size_t i = 0; i < fleets.size(); i++) {
+        FleetSimulator simulator(fleets[i], SIM_SEED + fleets[i]);
+        results.push_back(simulator.run(hours));
+        printStats(results.back());
+        fflush(stdout);
+    }
+
+    printf("\n%8s %10s %9s %9s %9s %9s %10s\n", "Nodos", "Entrega %", "p50 ms", "p99 ms", "Canal %", "Acks %", "Ciclo máx %");
+    for (size_t i = 0; i < results.size(); i++) {
+        const FleetStats& stats = results[i];
+        printf("%8u %10.2f %9llu %9llu %9.2f %9.2f %10.3f\n", stats.nodes,
+               percent(stats.delivered, stats.composed), (unsigned long long)stats.latencyP50,
+               (unsigned long long)stats.latencyP99, 100.0 * stats.uplinkAirtime / (stats.hours * 3600E6) / stats.channels,
+               percent(stats.acksReceived, stats.delivered), stats.maxDutyCycle);
+    }
+    return 0;
+}
@@ -0,0 +1,364 @@
+/**
+    Programa que ejercita la biblioteca LoRa contra el emulador del SX1278 (ver sx1278_emulator.h),
+    verificando su comportamiento y midiendo las transacciones SPI y la duración de los ISR:
+        - cola de transmisión (enqueuePacket()): contenido, orden y tiempo en el aire,
+        - cola de recepción (enableReceiveQueue()): contenido, RSSI y SNR,
+        - recepción por consulta (parsePacket()), con los timeouts de RX_SINGLE,
+        - escuchar antes de transmitir, con el canal ocupado por otros paquetes,
+        - ventanas de recepción (enableReceiveWindows()): respuestas tras cada transmisión,
+          ventanas periódicas y tiempo del radio en recepción.
+    Termina con código 1 si alguna verificación falla, por lo que sirve como prueba de
+    regresión de cambios en la biblioteca.
+    Para compilarlo y ejecutarlo (desde simulador/):
+        g++ -std=c++11 -O2 -I. -I../nodo-sisicic/libraries/LoRa/src lora_benchmark.cpp sx1278_emulator.cpp \
+            arduino_host.cpp ../nodo-sisicic/libraries/LoRa/src/LoRa.cpp -o lora_benchmark
+        ./lora_benchmark [cantidad de paquetes]
+    @file lora_benchmark.cpp
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <LoRa.h>
+
+#include "sx1278_emulator.h"
+
+/// Radio (igual que en el nodo).
+#define BENCHMARK_FREQ 433175000            // Frecuencia (en Hz).
+#define BENCHMARK_SF 7                      // Factor de ensanchamiento.
+#define BENCHMARK_BW 125000                 // Ancho de banda (en Hz).
+#define BENCHMARK_DIO0_PIN 2                // Pin de DIO0.
+#define BENCHMARK_DIO1_PIN 3                // Pin de DIO1.
+
+/// Escenarios.
+#define BENCHMARK_PACKETS 200               // Cantidad de paquetes por defecto.
+#define BENCHMARK_MAX_SIZE 60               // Máximo tamaño de los paquetes (entran en un slot de recepción).
+#define BENCHMARK_LOOP_MS 5                 // Período del loop que vacía la cola de recepción (en ms).
+#define BENCHMARK_SEED 20009                // Semilla del generador.
+#define BENCHMARK_RX_WINDOW 200             // Duración de las ventanas de recepción (en ms).
+#define BENCHMARK_RESPONSE_DELAY 100        // Demora de la respuesta a cada transmisión (en ms).
+#define BENCHMARK_REPORT_PERIOD 2000        // Período de transmisión con ventanas de recepción (en ms).
+#define BENCHMARK_WINDOW_PACKETS 50         // Máxima cantidad de transmisiones con ventanas de recepción.
+
+static SX1278Emulator radio(BENCHMARK_DIO0_PIN, BENCHMARK_DIO1_PIN);
+static int failures = 0;
+
+/**
+    check() registra el resultado de una verificación.
+    @param ok Si la verificación se cumple.
+    @param what Descripción de la verificación.
+*/
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "ERROR: %s\n", what);
+        failures++;
+    }
+}
+
+/**
+    nextRandom() genera un número pseudoaleatorio (xorshift32), para que los paquetes
+    sean los mismos en cada ejecución.
+    @param &state Estado del generador (distinto de 0).
+    @return Siguiente número.
+*/
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+    generatePackets() genera paquetes de entre 1 y BENCHMARK_MAX_SIZE bytes.
+    @param count Cantidad de paquetes.
+    @return Paquetes generados.
+*/
+static std::vector<std::vector<uint8_t> > generatePackets(size_t count) {
+    std::vector<std::vector<uint8_t> > packets(count);
+    uint32_t state = BENCHMARK_SEED;
+    for (size_t i = 0; i < count; i++) {
+        packets[i].resize(1 + nextRandom(state) % BENCHMARK_MAX_SIZE);
+        for (size_t j = 0; j < packets[i].size(); j++) {
+            packets[i][j] = nextRandom(state);
+        }
+    }
+    return packets;
+}
+
+/**
+    resetCounters() pone en cero los contadores del emulador, de la biblioteca y de las interrupciones.
+*/
+static void resetCounters() {
+    radio.resetCounters();
+    LoRa.resetSpiTransactions();
+    hostResetInterruptStats();
+}
+
+/**
+    printStats() informa las transacciones SPI y las estadísticas de los ISR de un escenario.
+    Como el emulador despacha cada flanco en cuanto las interrupciones están habilitadas, no se informa
+    la latencia de los ISR (sería siempre 0), sino cuántas transacciones SPI hace cada uno.
+    @param name Nombre del escenario.
+    @param packets Cantidad de paquetes del escenario.
+    @param start Instante (de la computadora) en que comenzó el escenario.
+*/
+static void printStats(const char* name, size_t packets, std::chrono::steady_clock::time_point start) {
+    double hostNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    const InterruptStats& isr = hostInterruptStats(BENCHMARK_DIO0_PIN);
+    unsigned long count = isr.count > 0 ? isr.count : 1;
+    unsigned long isrs = isr.count + hostInterruptStats(BENCHMARK_DIO1_PIN).count;
+    printf("%s: %zu paquetes, %.1f transacciones SPI/paquete (%.1f bytes), %.2f en ISR/paquete\n",
+           name, packets, (double)radio.transactions() / packets, (double)radio.bytes() / packets,
+           (double)radio.isrTransactions() / packets);
+    printf("    ISR de DIO0: %lu, duración %.1f us (máx. %.1f us), %lu flancos perdidos; %.1f transacciones SPI por ISR (DIO0 y DIO1)\n",
+           isr.count, isr.totalDuration / 1e3 / count, isr.maxDuration / 1e3, isr.coalesced,
+           isrs > 0 ? (double)radio.isrTransactions() / isrs : 0);
+    printf("    Simulados %.1f s en %.1f ms (%.0f paquetes/s)\n",
+           hostNanos() / 1e9, hostNs / 1e6, packets * 1e9 / hostNs);
+}
+
+/**
+    transmitQueue() encola todos los paquetes, esperando cuando la cola está llena, y verifica
+    que se transmitan completos, en orden y con su tiempo en el aire.
+    @param packets Paquetes a transmitir.
+*/
+static void transmitQueue(const std::vector<std::vector<uint8_t> >& packets) {
+    resetCounters();
+    radio.clearTransmitted();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packets.size(); i++) {
+        while (!LoRa.enqueuePacket(packets[i].data(), packets[i].size())) {
+            delay(1);
+        }
+    }
+    while (LoRa.isTxBusy()) {
+        delay(1);
+    }
+
+    const std::vector<AirPacket>& sent = radio.transmitted();
+    check(sent.size() == packets.size(), "cola de transmisión: cantidad de paquetes");
+    for (size_t i = 0; i < sent.size() && i < packets.size(); i++) {
+        check(sent[i].data == packets[i], "cola de transmisión: contenido");
+        long airtime = (sent[i].end - sent[i].start) / 1000;
+        check(labs(airtime - (long)LoRa.timeOnAir(packets[i].size())) <= 1, "cola de transmisión: tiempo en el aire");
+        check(i == 0 || sent[i].start >= sent[i - 1].end, "cola de transmisión: paquetes superpuestos");
+    }
+    check(radio.opMode() == SX1278_MODE_RX_CONTINUOUS, "cola de transmisión: vuelve a recepción");
+    printStats("Cola de transmisión", packets.size(), start);
+}
+
+/**
+    receiveQueue() inyecta los paquetes uno a continuación del otro y los retira de la cola
+    de recepción cada BENCHMARK_LOOP_MS ms, como el loop del nodo.
+    @param packets Paquetes a recibir.
+*/
+static void receiveQueue(const std::vector<std::vector<uint8_t> >& packets) {
+    LoRa.enableReceiveQueue();
+    LoRa.receive();
+    resetCounters();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long offset = 1000;
+    for (size_t i = 0; i < packets.size(); i++) {
+        offset += radio.injectPacket(packets[i].data(), packets[i].size(), offset, -60 - (int)(i % 50), 10 - (float)(i % 20) / 2) + 500;
+    }
+
+    size_t received = 0;
+    LoRaPacket packet;
+    unsigned long deadline = millis() + offset / 1000 + 100;
+    while ((long)(millis() - deadline) < 0) {
+        delay(BENCHMARK_LOOP_MS);
+        while (LoRa.popPacket(packet)) {
+            if (received < packets.size()) {
+                const std::vector<uint8_t>& expected = packets[received];
+                check(packet.length == expected.size() && std::equal(expected.begin(), expected.end(), packet.data),
+                      "cola de recepción: contenido");
+                check(packet.rssi == -60 - (int)(received % 50), "cola de recepción: RSSI");
+                check(packet.snr == 10 - (float)(received % 20) / 2, "cola de recepción: SNR");
+            }
+            received++;
+        }
+    }
+    check(received == packets.size(), "cola de recepción: cantidad de paquetes");
+    check(LoRa.droppedPackets() == 0, "cola de recepción: paquetes descartados");
+    printStats("Cola de recepción", packets.size(), start);
+    LoRa.disableReceiveQueue();
+}
+
+/**
+    pollReceive() recibe los paquetes con parsePacket(), que usa RX_SINGLE: entre paquetes,
+    el radio vuelve a STDBY por timeout y parsePacket() lo vuelve a poner a recibir.
+    @param packets Paquetes a recibir.
+*/
+static void pollReceive(const std::vector<std::vector<uint8_t> >& packets) {
+    resetCounters();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    size_t received = 0;
+    uint8_t data[MAX_PKT_LENGTH];
+    LoRa.parsePacket();
+    for (size_t i = 0; i < packets.size(); i++) {
+        radio.injectPacket(packets[i].data(), packets[i].size(), 30000);
+        unsigned long deadline = millis() + 30 + LoRa.timeOnAir(packets[i].size()) / 1000 + 10;
+        while ((long)(millis() - deadline) < 0) {
+            int length = LoRa.parsePacket();
+            if (length > 0) {
+                size_t read = LoRa.readBytes(data, length);
+                check(read == packets[i].size() && std::equal(data, data + read, packets[i].begin()),
+                      "recepción por consulta: contenido");
+                received++;
+            }
+            delay(1);
+        }
+    }
+    check(received == packets.size(), "recepción por consulta: cantidad de paquetes");
+    printStats("Recepción por consulta", packets.size(), start);
+    printf("    En RX_SINGLE %.1f%% del tiempo\n",
+           100.0 * radio.timeInMode(SX1278_MODE_RX_SINGLE) / (radio.timeInMode(SX1278_MODE_RX_SINGLE)
+           + radio.timeInMode(SX1278_MODE_STDBY)));
+    LoRa.receive();
+}
+
+/**
+    listenBeforeTalk() transmite con el canal ocupado por paquetes de otros nodos durante la primera
+    mitad del escenario, verificando que la biblioteca espere y transmita todo igual.
+    @param packets Paquetes a transmitir.
+*/
+static void listenBeforeTalk(const std::vector<std::vector<uint8_t> >& packets) {
+    uint8_t foreign[BENCHMARK_MAX_SIZE] = {0};
+    unsigned long offset = 0;
+    for (size_t i = 0; i < packets.size() / 2 + 1; i++) {
+        offset += radio.injectPacket(foreign, sizeof(foreign), offset) + 2000;
+    }
+
+    LoRa.enableListenBeforeTalk();
+    resetCounters();
+    radio.clearTransmitted();
+    unsigned int busyBefore = LoRa.channelBusyCount();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packets.size(); i++) {
+        while (!LoRa.enqueuePacket(packets[i].data(), packets[i].size())) {
+            LoRa.poll();
+            delay(1);
+        }
+    }
+    while (LoRa.isTxBusy()) {
+        LoRa.poll();
+        delay(1);
+    }
+
+    const std::vector<AirPacket>& sent = radio.transmitted();
+    check(sent.size() == packets.size(), "escuchar antes de transmitir: cantidad de paquetes");
+    for (size_t i = 0; i < sent.size() && i < packets.size(); i++) {
+        check(sent[i].data == packets[i], "escuchar antes de transmitir: contenido");
+    }
+    check(LoRa.channelBusyCount() > busyBefore, "escuchar antes de transmitir: canal ocupado sin detectar");
+    printStats("Escuchar antes de transmitir", packets.size(), start);
+    printf("    Canal ocupado %u veces\n", LoRa.channelBusyCount() - busyBefore);
+    LoRa.disableListenBeforeTalk();
+}
+
+/**
+    receiveWindows() transmite cada BENCHMARK_REPORT_PERIOD ms con ventanas de recepción, respondiendo
+    a cada transmisión BENCHMARK_RESPONSE_DELAY ms después de que termina (como el "ack" del concentrador),
+    y verifica que se reciban todas las respuestas, que un paquete fuera de ventana se pierda, que una
+    ventana periódica reciba y que el radio duerma entre ventanas.
+    @param packets Paquetes a transmitir.
+*/
+static void receiveWindows(const std::vector<std::vector<uint8_t> >& packets) {
+    const uint8_t response[] = {'a', 'c', 'k'};
+    size_t count = std::min(packets.size(), (size_t)BENCHMARK_WINDOW_PACKETS);
+    radio.setTransmitHandler([&](const AirPacket&) {
+        radio.injectPacket(response, sizeof(response), BENCHMARK_RESPONSE_DELAY * 1000UL);
+    });
+
+    LoRa.enableReceiveQueue();
+    LoRa.enableReceiveWindows(BENCHMARK_RX_WINDOW);
+    check(radio.opMode() == SX1278_MODE_SLEEP, "ventanas de recepción: duerme al habilitarlas");
+    resetCounters();
+    radio.clearTransmitted();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    size_t received = 0;
+    LoRaPacket packet;
+    for (size_t i = 0; i < count; i++) {
+        LoRa.enqueuePacket(packets[i].data(), packets[i].size());
+        unsigned long deadline = millis() + BENCHMARK_REPORT_PERIOD;
+        while ((long)(millis() - deadline) < 0) {
+            delay(BENCHMARK_LOOP_MS);
+            LoRa.poll();
+            while (LoRa.popPacket(packet)) {
+                check(packet.length == sizeof(response) && std::equal(response, response + sizeof(response), packet.data),
+                      "ventanas de recepción: contenido");
+                received++;
+            }
+        }
+        check(!LoRa.isReceiveWindowOpen() && radio.opMode() == SX1278_MODE_SLEEP,
+              "ventanas de recepción: duerme entre ventanas");
+    }
+    check(radio.transmitted().size() == count, "ventanas de recepción: cantidad de transmisiones");
+    check(received == count, "ventanas de recepción: cantidad de respuestas");
+    uint64_t total = 0;
+    for (uint8_t mode = SX1278_MODE_SLEEP; mode <= SX1278_MODE_CAD; mode++) {
+        total += radio.timeInMode(mode);
+    }
+    printStats("Ventanas de recepción", count, start);
+    printf("    En recepción %.2f%% del tiempo, dormido %.2f%%\n",
+           100.0 * radio.timeInMode(SX1278_MODE_RX_SINGLE) / total, 100.0 * radio.timeInMode(SX1278_MODE_SLEEP) / total);
+    radio.setTransmitHandler(std::function<void(const AirPacket&)>());
+
+    // Un paquete fuera de ventana se pierde, uno dentro de una ventana periódica se recibe.
+    radio.injectPacket(response, sizeof(response), 10000);
+    delay(100);
+    LoRa.receiveWindow();
+    check(LoRa.isReceiveWindowOpen() && radio.opMode() == SX1278_MODE_RX_SINGLE, "ventanas de recepción: ventana periódica");
+    radio.injectPacket(response, sizeof(response), BENCHMARK_RESPONSE_DELAY * 1000UL);
+    delay(BENCHMARK_RX_WINDOW + BENCHMARK_LOOP_MS);
+    received = 0;
+    while (LoRa.popPacket(packet)) {
+        received++;
+    }
+    check(received == 1, "ventanas de recepción: paquetes de la ventana periódica");
+    check(!LoRa.isReceiveWindowOpen() && radio.opMode() == SX1278_MODE_SLEEP, "ventanas de recepción: cierre de la ventana periódica");
+
+    LoRa.disableReceiveWindows();
+    check(radio.opMode() == SX1278_MODE_RX_CONTINUOUS, "ventanas de recepción: vuelve a recepción continua");
+    LoRa.disableReceiveQueue();
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : BENCHMARK_PACKETS;
+    if (count == 0) {
+        fprintf(stderr, "Uso: %s [cantidad de paquetes]\n", argv[0]);
+        return 1;
+    }
+
+    LoRa.setSPI(radio);
+    LoRa.setPins(10, 9, BENCHMARK_DIO0_PIN, BENCHMARK_DIO1_PIN);
+    resetCounters();
+    check(LoRa.begin(BENCHMARK_FREQ) == 1, "begin(): versión del radio");
+    printf("begin(): %lu transacciones SPI\n", radio.transactions());
+    LoRa.setSpreadingFactor(BENCHMARK_SF);
+    LoRa.setSignalBandwidth(BENCHMARK_BW);
+    LoRa.enableCrc();
+    LoRa.receive();
+    check(radio.opMode() == SX1278_MODE_RX_CONTINUOUS, "receive(): modo del radio");
+    check(labs((long)LoRa.timeOnAir(20) - (long)(radio.airtime(20, false) / 1000)) <= 1, "timeOnAir(): difiere del emulador");
+
+    std::vector<std::vector<uint8_t> > packets = generatePackets(count);
+    transmitQueue(packets);
+    receiveQueue(packets);
+    pollReceive(packets);
+    listenBeforeTalk(packets);
+    receiveWindows(packets);
+
+    if (failures > 0) {
+        fprintf(stderr, "%d verificaciones fallidas\n", failures);
+        return 1;
+    }
+    printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
@@ -0,0 +1,530 @@
+/**
+    Implementación del modelo del SX1278 (ver sx1278_emulator.h). Los registros y sus valores
+    de reset son los de la página LoRa del datasheet (Semtech SX1276/77/78/79, 6.4).
+    @file sx1278_emulator.cpp
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "sx1278_emulator.h"
+
+/// Registros.
+#define REG_FIFO 0x00
+#define REG_OP_MODE 0x01
+#define REG_FRF_MSB 0x06
+#define REG_FRF_MID 0x07
+#define REG_FRF_LSB 0x08
+#define REG_PA_CONFIG 0x09
+#define REG_FIFO_ADDR_PTR 0x0d
+#define REG_FIFO_TX_BASE_ADDR 0x0e
+#define REG_FIFO_RX_BASE_ADDR 0x0f
+#define REG_FIFO_RX_CURRENT_ADDR 0x10
+#define REG_IRQ_FLAGS_MASK 0x11
+#define REG_IRQ_FLAGS 0x12
+#define REG_RX_NB_BYTES 0x13
+#define REG_PKT_SNR_VALUE 0x19
+#define REG_PKT_RSSI_VALUE 0x1a
+#define REG_RSSI_VALUE 0x1b
+#define REG_MODEM_CONFIG_1 0x1d
+#define REG_MODEM_CONFIG_2 0x1e
+#define REG_SYMB_TIMEOUT_LSB 0x1f
+#define REG_PREAMBLE_MSB 0x20
+#define REG_PREAMBLE_LSB 0x21
+#define REG_PAYLOAD_LENGTH 0x22
+#define REG_FIFO_RX_BYTE_ADDR 0x25
+#define REG_MODEM_CONFIG_3 0x26
+#define REG_RSSI_WIDEBAND 0x2c
+#define REG_SYNC_WORD 0x39
+#define REG_DIO_MAPPING_1 0x40
+#define REG_VERSION 0x42
+#define REG_PA_DAC 0x4d
+
+/// Banderas de RegIrqFlags.
+#define IRQ_CAD_DETECTED 0x01
+#define IRQ_FHSS_CHANGE_CHANNEL 0x02
+#define IRQ_CAD_DONE 0x04
+#define IRQ_TX_DONE 0x08
+#define IRQ_VALID_HEADER 0x10
+#define IRQ_PAYLOAD_CRC_ERROR 0x20
+#define IRQ_RX_DONE 0x40
+#define IRQ_RX_TIMEOUT 0x80
+
+#define MODE_LONG_RANGE 0x80
+#define RF_MID_BAND_THRESHOLD 525000000     // Límite entre los puertos LF y HF (en Hz).
+
+/// Anchos de banda de cada código de RegModemConfig1 (en Hz).
+static const long bandwidths[] = {7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000};
+
+/// Fuente de DIO0 y DIO1 para cada valor de su mapeo en RegDioMapping1.
+static const uint8_t dio0Sources[] = {IRQ_RX_DONE, IRQ_TX_DONE, IRQ_CAD_DONE, 0};
+static const uint8_t dio1Sources[] = {IRQ_RX_TIMEOUT, IRQ_FHSS_CHANGE_CHANNEL, IRQ_CAD_DETECTED, 0};
+
+SX1278Emulator::SX1278Emulator(int dio0Pin, int dio1Pin) :
+    _dio0Pin(dio0Pin),
+    _dio1Pin(dio1Pin),
+    _spiClock(4000000),
+    _address(-1),
+    _writing(false),
+    _nextId(1),
+    _transactions(0),
+    _isrTransactions(0),
+    _bytes(0),
+    _randomState(0x5eed1278) {
+    reset();
+    hostAddDevice(this);
+}
+
+SX1278Emulator::~SX1278Emulator() {
+    hostRemoveDevice(this);
+}
+
+void SX1278Emulator::reset() {
+    memset(_regs, 0, sizeof(_regs));
+    memset(_fifo, 0, sizeof(_fifo));
+    _regs[REG_OP_MODE] = 0x09;
+    _regs[REG_FRF_MSB] = 0x6c;
+    _regs[REG_FRF_MID] = 0x80;
+    _regs[REG_PA_CONFIG] = 0x4f;
+    _regs[0x0a] = 0x09;                     // RegPaRamp.
+    _regs[0x0b] = 0x2b;                     // RegOcp.
+    _regs[0x0c] = 0x20;                     // RegLna.
+    _regs[REG_FIFO_TX_BASE_ADDR] = 0x80;
+    _regs[REG_MODEM_CONFIG_1] = 0x72;
+    _regs[REG_MODEM_CONFIG_2] = 0x70;
+    _regs[REG_SYMB_TIMEOUT_LSB] = 0x64;
+    _regs[REG_PREAMBLE_LSB] = 0x08;
+    _regs[REG_PAYLOAD_LENGTH] = 0x01;
+    _regs[0x23] = 0xff;                     // RegMaxPayloadLength.
+    _regs[0x31] = 0xc3;                     // RegDetectOptimize.
+    _regs[0x33] = 0x27;                     // RegInvertIQ.
+    _regs[0x37] = 0x0a;                     // RegDetectionThreshold.
+    _regs[REG_SYNC_WORD] = 0x12;
+    _regs[0x3b] = 0x1d;                     // RegInvertIQ2.
+    _regs[REG_VERSION] = 0x12;
+    _regs[REG_PA_DAC] = 0x84;
+    _rxByteAddr = 0;
+
+    _modeDeadline = HOST_NEVER;
+    _modeSince = hostNanos();
+    _modeStart = _modeSince;
+    memset(_modeTime, 0, sizeof(_modeTime));
+    _air.clear();
+    _rxLock = 0;
+    _activity = false;
+    _activityRssi = SX1278_NOISE_FLOOR;
+    updateDio();
+}
+
+void SX1278Emulator::beginTransaction(SPISettings settings) {
+    SPIClass::beginTransaction(settings);
+    _spiClock = settings.clock > 0 ? settings.clock : 1;
+    _address = -1;
+    _transactions++;
+    if (hostInInterrupt()) {
+        _isrTransactions++;
+    }
+    hostAdvance(SX1278_TRANSACTION_NS);
+}
+
+/**
+    transfer() intercambia un byte: el primero de cada transacción es la dirección (bit 7 en 1
+    para escribir), y los siguientes son datos de registros consecutivos, salvo en REG_FIFO,
+    donde avanza REG_FIFO_ADDR_PTR.
+    @param data Byte recibido por MOSI.
+    @return Byte devuelto por MISO.
+*/
+uint8_t SX1278Emulator::transfer(uint8_t data) {
+    uint8_t response = 0;
+    if (_address < 0) {
+        _address = data & 0x7f;
+        _writing = (data & 0x80) != 0;
+    } else {
+        if (_writing) {
+            writeRegister(_address, data);
+        } else {
+            response = readRegister(_address);
+        }
+        if (_address != REG_FIFO) {
+            _address = (_address + 1) & 0x7f;
+        }
+    }
+    _bytes++;
+    hostAdvance((8ULL * 1000000000ULL + _spiClock - 1) / _spiClock);
+    return response;
+}
+
+void SX1278Emulator::endTransaction() {
+    _address = -1;
+    SPIClass::endTransaction();
+}
+
+uint64_t SX1278Emulator::nextEvent() {
+    uint64_t next = _modeDeadline;
+    for (size_t i = 0; i < _air.size(); i++) {
+        uint64_t event = _air[i].started ? _air[i].packet.end : _air[i].packet.start;
+        if (event < next) {
+            next = event;
+        }
+    }
+    return next;
+}
+
+void SX1278Emulator::runEvent() {
+    size_t first = _air.size();
+    uint64_t when = _modeDeadline;
+    for (size_t i = 0; i < _air.size(); i++) {
+        uint64_t event = _air[i].started ? _air[i].packet.end : _air[i].packet.start;
+        if (event < when) {
+            when = event;
+            first = i;
+        }
+    }
+    if (first == _air.size()) {
+        finishMode();
+        return;
+    }
+    if (!_air[first].started) {
+        _air[first].started = true;
+        packetStarted(_air[first]);
+    } else {
+        OnAir air = _air[first];
+        _air.erase(_air.begin() + first);
+        packetEnded(air);
+    }
+}
+
+AirPacket SX1278Emulator::airPacket(const uint8_t data[], size_t len, unsigned long delayUs) {
+    AirPacket packet;
+    packet.data.assign(data, data + len);
+    packet.start = hostNanos() + (uint64_t)delayUs * 1000;
+    packet.implicitHeader = _regs[REG_MODEM_CONFIG_1] & 0x01;
+    packet.end = packet.start + airtime(len, packet.implicitHeader);
+    packet.frf = frequencyRegister();
+    packet.sf = _regs[REG_MODEM_CONFIG_2] >> 4;
+    packet.bandwidth = _regs[REG_MODEM_CONFIG_1] >> 4;
+    packet.syncWord = _regs[REG_SYNC_WORD];
+    packet.power = -80;
+    packet.snr = 9;
+    packet.crcError = false;
+    return packet;
+}
+
+void SX1278Emulator::inject(const AirPacket& packet) {
+    OnAir air;
+    air.packet = packet;
+    air.packet.start = std::max(packet.start, hostNanos());
+    air.packet.end = std::max(packet.end, air.packet.start);
+    air.id = _nextId++;
+    air.started = false;
+    _air.push_back(air);
+}
+
+unsigned long SX1278Emulator::injectPacket(const uint8_t data[], size_t len, unsigned long delayUs, int rssi, float snr) {
+    AirPacket packet = airPacket(data, len, delayUs);
+    packet.power = rssi;
+    packet.snr = snr;
+    inject(packet);
+    return (packet.end - packet.start) / 1000;
+}
+
+void SX1278Emulator::setChannelActivity(bool active, int rssi) {
+    _activity = active;
+    _activityRssi = rssi;
+}
+
+void SX1278Emulator::setTransmitHandler(std::function<void(const AirPacket&)> handler) {
+    _transmitHandler = handler;
+}
+
+uint64_t SX1278Emulator::symbolTime() const {
+    uint8_t code = _regs[REG_MODEM_CONFIG_1] >> 4;
+    long bandwidth = bandwidths[code < 10 ? code : 9];
+    return ((uint64_t)1000000000 << (_regs[REG_MODEM_CONFIG_2] >> 4)) / bandwidth;
+}
+
+uint64_t SX1278Emulator::airtime(size_t size, bool implicitHeader) const {
+    int sf = _regs[REG_MODEM_CONFIG_2] >> 4;
+    int cr = (_regs[REG_MODEM_CONFIG_1] >> 1) & 0x07;
+    bool crc = _regs[REG_MODEM_CONFIG_2] & 0x04;
+    bool ldo = _regs[REG_MODEM_CONFIG_3] & 0x08;
+    long preamble = ((long)_regs[REG_PREAMBLE_MSB] << 8) | _regs[REG_PREAMBLE_LSB];
+
+    long numerator = 8L * size - 4L * sf + 28 + (crc ? 16 : 0) - (implicitHeader ? 20 : 0);
+    long denominator = 4L * (sf - (ldo ? 2 : 0));
+    long payloadSymbols = 8;
+    if (numerator > 0) {
+        payloadSymbols += ((numerator + denominator - 1) / denominator) * (cr + 4);
+    }
+    return (uint64_t)llround((preamble + 4.25 + payloadSymbols) * symbolTime());
+}
+
+uint64_t SX1278Emulator::timeInMode(uint8_t mode) {
+    uint64_t now = hostNanos();
+    _modeTime[opMode()] += now - _modeSince;
+    _modeSince = now;
+    return _modeTime[mode & 0x07];
+}
+
+void SX1278Emulator::resetCounters() {
+    _transactions = 0;
+    _isrTransactions = 0;
+    _bytes = 0;
+    _modeSince = hostNanos();
+    memset(_modeTime, 0, sizeof(_modeTime));
+}
+
+uint8_t SX1278Emulator::readRegister(uint8_t address) {
+    switch (address) {
+        case REG_FIFO:
+            // La FIFO no es accesible en SLEEP.
+            return opMode() == SX1278_MODE_SLEEP ? 0 : _fifo[_regs[REG_FIFO_ADDR_PTR]++];
+        case REG_RSSI_VALUE:
+            return constrain(channelRssi() + rssiOffset(), 0, 255);
+        case REG_RSSI_WIDEBAND:
+            return nextRandom();
+        default:
+            return _regs[address];
+    }
+}
+
+void SX1278Emulator::writeRegister(uint8_t address, uint8_t value) {
+    switch (address) {
+        case REG_FIFO:
+            if (opMode() != SX1278_MODE_SLEEP) {
+                _fifo[_regs[REG_FIFO_ADDR_PTR]++] = value;
+            }
+            break;
+        case REG_OP_MODE: {
+            // LongRangeMode sólo cambia en SLEEP (o al entrar en SLEEP).
+            uint8_t mode = value & 0x07;
+            if (opMode() != SX1278_MODE_SLEEP && mode != SX1278_MODE_SLEEP) {
+                value = (value & ~MODE_LONG_RANGE) | (_regs[REG_OP_MODE] & MODE_LONG_RANGE);
+            }
+            _regs[REG_OP_MODE] = (value & 0xf8) | opMode();
+            if (mode != opMode()) {
+                setMode(mode);
+            }
+            break;
+        }
+        case REG_IRQ_FLAGS:
+            // Se borran escribiendo 1.
+            _regs[REG_IRQ_FLAGS] &= ~value;
+            updateDio();
+            break;
+        case REG_DIO_MAPPING_1:
+            _regs[REG_DIO_MAPPING_1] = value;
+            updateDio();
+            break;
+        case REG_FIFO_RX_CURRENT_ADDR:
+        case REG_RX_NB_BYTES:
+        case 0x14: case 0x15: case 0x16: case 0x17: case 0x18:
+        case REG_PKT_SNR_VALUE:
+        case REG_PKT_RSSI_VALUE:
+        case REG_RSSI_VALUE:
+        case 0x1c:
+        case REG_FIFO_RX_BYTE_ADDR:
+        case 0x28: case 0x29: case 0x2a:
+        case REG_RSSI_WIDEBAND:
+        case REG_VERSION:
+            // Sólo lectura.
+            break;
+        default:
+            _regs[address] = value;
+            break;
+    }
+}
+
+/**
+    setMode() cambia el modo de operación, programando el fin de los modos que terminan solos:
+    TX (al transmitir el payload), CAD (después de un símbolo más 32 chips) y RX_SINGLE
+    (después de RegSymbTimeout símbolos sin preámbulo).
+    @param mode Modo nuevo.
+*/
+void SX1278Emulator::setMode(uint8_t mode) {
+    uint64_t now = hostNanos();
+    uint8_t previous = opMode();
+    _modeTime[previous] += now - _modeSince;
+    _modeSince = now;
+    _modeStart = now;
+    _modeDeadline = HOST_NEVER;
+    _regs[REG_OP_MODE] = (_regs[REG_OP_MODE] & 0xf8) | mode;
+
+    bool receiving = mode == SX1278_MODE_RX_CONTINUOUS || mode == SX1278_MODE_RX_SINGLE;
+    if (!receiving) {
+        _rxLock = 0;
+    } else if (previous != SX1278_MODE_RX_CONTINUOUS && previous != SX1278_MODE_RX_SINGLE) {
+        _rxByteAddr = _regs[REG_FIFO_RX_BASE_ADDR];
+    }
+
+    if (mode == SX1278_MODE_TX) {
+        bool implicit = _regs[REG_MODEM_CONFIG_1] & 0x01;
+        uint8_t length = _regs[REG_PAYLOAD_LENGTH];
+        uint8_t base = _regs[REG_FIFO_TX_BASE_ADDR];
+        _txPacket.data.resize(length);
+        for (uint8_t i = 0; i < length; i++) {
+            _txPacket.data[i] = _fifo[(uint8_t)(base + i)];
+        }
+        _txPacket.start = now;
+        _txPacket.end = now + airtime(length, implicit);
+        _txPacket.frf = frequencyRegister();
+        _txPacket.sf = _regs[REG_MODEM_CONFIG_2] >> 4;
+        _txPacket.bandwidth = _regs[REG_MODEM_CONFIG_1] >> 4;
+        _txPacket.syncWord = _regs[REG_SYNC_WORD];
+        _txPacket.implicitHeader = implicit;
+        _txPacket.power = txPower();
+        _txPacket.snr = 0;
+        _txPacket.crcError = false;
+        _modeDeadline = _txPacket.end;
+    } else if (mode == SX1278_MODE_CAD) {
+        _modeDeadline = now + symbolTime() + symbolTime() * 32 / (1 << (_regs[REG_MODEM_CONFIG_2] >> 4));
+    } else if (mode == SX1278_MODE_RX_SINGLE) {
+        uint16_t symbols = ((uint16_t)(_regs[REG_MODEM_CONFIG_2] & 0x03) << 8) | _regs[REG_SYMB_TIMEOUT_LSB];
+        _modeDeadline = now + symbols * symbolTime();
+    }
+}
+
+/**
+    finishMode() termina el modo actual al llegar a su _modeDeadline, volviendo a STDBY.
+*/
+void SX1278Emulator::finishMode() {
+    uint8_t mode = opMode();
+    setMode(SX1278_MODE_STDBY);
+
+    if (mode == SX1278_MODE_TX) {
+        _transmitted.push_back(_txPacket);
+        setIrqFlags(IRQ_TX_DONE);
+        if (_transmitHandler) {
+            _transmitHandler(_txPacket);
+        }
+    } else if (mode == SX1278_MODE_CAD) {
+        // Detecta los preámbulos presentes durante el CAD, con la misma frecuencia y SF.
+        bool detected = _activity;
+        for (size_t i = 0; i < _air.size() && !detected; i++) {
+            const AirPacket& packet = _air[i].packet;
+            detected = packet.start < hostNanos() && packet.end > _modeStart
+                && packet.frf == frequencyRegister() && packet.sf == (_regs[REG_MODEM_CONFIG_2] >> 4);
+        }
+        setIrqFlags(IRQ_CAD_DONE | (detected ? IRQ_CAD_DETECTED : 0));
+    } else if (mode == SX1278_MODE_RX_SINGLE) {
+        setIrqFlags(IRQ_RX_TIMEOUT);
+    }
+}
+
+/**
+    listensTo() determina si el radio puede recibir un paquete que comienza ahora.
+    @param packet Paquete.
+    @return true si está en recepción, libre y con la misma configuración del paquete.
+*/
+bool SX1278Emulator::listensTo(const AirPacket& packet) const {
+    uint8_t mode = opMode();
+    return (mode == SX1278_MODE_RX_CONTINUOUS || mode == SX1278_MODE_RX_SINGLE) && _rxLock == 0
+        && packet.frf == frequencyRegister() && packet.sf == (_regs[REG_MODEM_CONFIG_2] >> 4)
+        && packet.bandwidth == (_regs[REG_MODEM_CONFIG_1] >> 4) && packet.syncWord == _regs[REG_SYNC_WORD]
+        && packet.implicitHeader == (bool)(_regs[REG_MODEM_CONFIG_1] & 0x01);
+}
+
+void SX1278Emulator::packetStarted(const OnAir& air) {
+    if (!listensTo(air.packet)) {
+        return;
+    }
+    // El preámbulo detectado detiene el timeout de RX_SINGLE.
+    _rxLock = air.id;
+    _modeDeadline = HOST_NEVER;
+}
+
+/**
+    packetEnded() copia en la FIFO un paquete recibido completo, a partir de RegFifoRxByteAddr
+    (en RX_CONTINUOUS, los paquetes siguientes quedan a continuación).
+    @param air Paquete que terminó.
+*/
+void SX1278Emulator::packetEnded(const OnAir& air) {
+    if (_rxLock != air.id) {
+        return;
+    }
+    _rxLock = 0;
+    const AirPacket& packet = air.packet;
+    size_t length = packet.implicitHeader ? _regs[REG_PAYLOAD_LENGTH] : packet.data.size();
+
+    uint8_t start = _rxByteAddr;
+    for (size_t i = 0; i < length; i++) {
+        _fifo[_rxByteAddr++] = i < packet.data.size() ? packet.data[i] : 0;
+    }
+    _regs[REG_FIFO_RX_CURRENT_ADDR] = start;
+    _regs[REG_FIFO_RX_BYTE_ADDR] = _rxByteAddr;
+    _regs[REG_RX_NB_BYTES] = length;
+    _regs[REG_PKT_SNR_VALUE] = (uint8_t)(int8_t)constrain(lround(packet.snr * 4), -128L, 127L);
+    _regs[REG_PKT_RSSI_VALUE] = constrain(packet.power + rssiOffset(), 0, 255);
+
+    if (opMode() == SX1278_MODE_RX_SINGLE) {
+        setMode(SX1278_MODE_STDBY);
+    }
+    setIrqFlags(IRQ_VALID_HEADER | IRQ_RX_DONE | (packet.crcError ? IRQ_PAYLOAD_CRC_ERROR : 0));
+}
+
+void SX1278Emulator::setIrqFlags(uint8_t flags) {
+    _regs[REG_IRQ_FLAGS] |= flags & ~_regs[REG_IRQ_FLAGS_MASK];
+    updateDio();
+}
+
+/**
+    updateDio() actualiza los niveles de DIO0 y DIO1 según las banderas y RegDioMapping1.
+*/
+void SX1278Emulator::updateDio() {
+    uint8_t mapping = _regs[REG_DIO_MAPPING_1];
+    uint8_t flags = _regs[REG_IRQ_FLAGS];
+    if (_dio0Pin >= 0) {
+        hostSetPin(_dio0Pin, (flags & dio0Sources[mapping >> 6]) ? HIGH : LOW);
+    }
+    if (_dio1Pin >= 0) {
+        hostSetPin(_dio1Pin, (flags & dio1Sources[(mapping >> 4) & 0x03]) ? HIGH : LOW);
+    }
+}
+
+/**
+    channelRssi() obtiene el RSSI actual del canal: el del paquete más fuerte en el aire
+    con la misma frecuencia, o el de la actividad simulada, o el piso de ruido.
+    @return RSSI (en dBm).
+*/
+int SX1278Emulator::channelRssi() const {
+    int rssi = _activity ? _activityRssi : SX1278_NOISE_FLOOR;
+    for (size_t i = 0; i < _air.size(); i++) {
+        if (_air[i].started && _air[i].packet.frf == frequencyRegister() && _air[i].packet.power > rssi) {
+            rssi = _air[i].packet.power;
+        }
+    }
+    return rssi;
+}
+
+/**
+    txPower() obtiene la potencia de salida configurada (6.4, RegPaConfig y RegPaDac).
+    @return Potencia (en dBm).
+*/
+int SX1278Emulator::txPower() const {
+    uint8_t config = _regs[REG_PA_CONFIG];
+    if (config & 0x80) {
+        return ((_regs[REG_PA_DAC] & 0x07) == 0x07) ? 5 + (config & 0x0f) : 2 + (config & 0x0f);
+    }
+    float maxPower = 10.8f + 0.6f * ((config >> 4) & 0x07);
+    return (int)lroundf(maxPower - (15 - (config & 0x0f)));
+}
+
+int SX1278Emulator::rssiOffset() const {
+    uint64_t frequency = ((uint64_t)frequencyRegister() * SX1278_FXOSC) >> 19;
+    return frequency < RF_MID_BAND_THRESHOLD ? 164 : 157;
+}
+
+uint32_t SX1278Emulator::frequencyRegister() const {
+    return ((uint32_t)_regs[REG_FRF_MSB] << 16) | ((uint32_t)_regs[REG_FRF_MID] << 8) | _regs[REG_FRF_LSB];
+}
+
+uint8_t SX1278Emulator::nextRandom() {
+    _randomState ^= _randomState << 13;
+    _randomState ^= _randomState >> 17;
+    _randomState ^= _randomState << 5;
+    return _randomState;
+}
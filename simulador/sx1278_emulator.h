@@ -0,0 +1,226 @@
+/**
+    Header que contiene un modelo por software del SX1278 (módulo RA-02) en modo LoRa, que ocupa
+    el lugar del bus SPI de la biblioteca LoRa (LoRa.setSPI()) para probarla en Linux sin hardware.
+    Emula el banco de registros, la FIFO con sus punteros, los modos de operación (SLEEP, STDBY,
+    TX, RX_CONTINUOUS, RX_SINGLE y CAD), las banderas de interrupción y los pines DIO0 y DIO1,
+    con las demoras reales: cada transmisión dura su tiempo en el aire (Semtech SX1276/77/78/79,
+    4.1.1.7) según los registros de configuración, y cada byte SPI lo que tarda en el bus.
+    El canal se simula inyectando paquetes (injectPacket()), que se reciben si el radio escucha
+    con la misma frecuencia, SF, ancho de banda, sync word y modo de header desde su comienzo
+    (a lo sumo uno a la vez), y los paquetes transmitidos quedan en transmitted().
+    Cuenta las transacciones SPI (las de los ISR por separado) y el tiempo en cada modo.
+    Por ejemplo:
+        SX1278Emulator radio(2);
+        LoRa.setSPI(radio);
+        LoRa.begin(433175000);
+        radio.injectPacket(data, sizeof(data), 1000);
+        delay(100);
+    @file sx1278_emulator.h
+    @author Franco Abosso
+    @author Julio Donadello
+    @version 1.0 17/10/2026
+*/
+
+#ifndef SX1278_EMULATOR_H
+#define SX1278_EMULATOR_H
+
+#include <functional>
+#include <vector>
+
+#include <Arduino.h>
+#include <SPI.h>
+
+/// Modos de operación (bits 2-0 de RegOpMode).
+#define SX1278_MODE_SLEEP 0
+#define SX1278_MODE_STDBY 1
+#define SX1278_MODE_FSTX 2
+#define SX1278_MODE_TX 3
+#define SX1278_MODE_FSRX 4
+#define SX1278_MODE_RX_CONTINUOUS 5
+#define SX1278_MODE_RX_SINGLE 6
+#define SX1278_MODE_CAD 7
+
+/// Temporización y canal.
+#define SX1278_TRANSACTION_NS 1000          // Demora fija de cada transacción SPI (NSS y llamada, en ns).
+#define SX1278_NOISE_FLOOR -120             // RSSI del canal libre (en dBm).
+#define SX1278_FXOSC 32000000               // Frecuencia del cristal (en Hz).
+
+/**
+    AirPacket contiene un paquete en el aire:
+        - data: contenido.
+        - start, end: comienzo y fin de la transmisión (en ns de tiempo virtual).
+        - frf: frecuencia (valor de RegFrf).
+        - sf, bandwidth: factor de ensanchamiento y código de ancho de banda (RegModemConfig1).
+        - syncWord: sync word.
+        - implicitHeader: si se transmite sin header.
+        - power: potencia de salida (en dBm) en los transmitidos, RSSI en los inyectados.
+        - snr: SNR con que se recibe (en dB).
+        - crcError: si se recibe con error de CRC.
+*/
+struct AirPacket {
+    std::vector<uint8_t> data;
+    uint64_t start;
+    uint64_t end;
+    uint32_t frf;
+    uint8_t sf;
+    uint8_t bandwidth;
+    uint8_t syncWord;
+    bool implicitHeader;
+    int power;
+    float snr;
+    bool crcError;
+};
+
+/**
+    SX1278Emulator emula un SX1278 conectado por SPI, con DIO0 (y opcionalmente DIO1) en pines
+    de interrupción simulados (ver Arduino.h).
+*/
+class SX1278Emulator : public SPIClass, public HostDevice {
+public:
+    /**
+        Constructor: registra el dispositivo en el reloj virtual y lo deja recién reseteado.
+        @param dio0Pin Pin conectado a DIO0 (-1 si no está conectado).
+        @param dio1Pin Pin conectado a DIO1 (-1 si no está conectado).
+    */
+    SX1278Emulator(int dio0Pin = 2, int dio1Pin = -1);
+    ~SX1278Emulator();
+
+    /**
+        reset() devuelve los registros y la FIFO a sus valores de reset, y descarta el canal.
+    */
+    void reset();
+
+    void beginTransaction(SPISettings settings);
+    uint8_t transfer(uint8_t data);
+    void endTransaction();
+
+    uint64_t nextEvent();
+    void runEvent();
+
+    /**
+        airPacket() prepara un paquete con la configuración actual del radio, para inyectarlo
+        (con inject()) después de modificarlo.
+        @param data Contenido.
+        @param len Cantidad de bytes.
+        @param delayUs Demora hasta su comienzo (en us).
+        @return Paquete, con la duración de su tiempo en el aire.
+    */
+    AirPacket airPacket(const uint8_t data[], size_t len, unsigned long delayUs = 0);
+
+    /**
+        inject() agrega un paquete al canal.
+        @param packet Paquete a agregar (su comienzo no puede ser anterior al instante actual).
+    */
+    void inject(const AirPacket& packet);
+
+    /**
+        injectPacket() agrega al canal un paquete con la configuración actual del radio.
+        @param data Contenido.
+        @param len Cantidad de bytes.
+        @param delayUs Demora hasta su comienzo (en us).
+        @param rssi RSSI con que se recibe (en dBm).
+        @param snr SNR con que se recibe (en dB).
+        @return Duración del paquete en el aire (en us).
+    */
+    unsigned long injectPacket(const uint8_t data[], size_t len, unsigned long delayUs = 0, int rssi = -80, float snr = 9);
+
+    /**
+        setChannelActivity() simula actividad en el canal (otro sistema, ruido) que detecta el CAD
+        y eleva el RSSI, sin paquetes que recibir.
+        @param active Si hay actividad.
+        @param rssi RSSI de la actividad (en dBm).
+    */
+    void setChannelActivity(bool active, int rssi = -70);
+
+    /**
+        setTransmitHandler() registra una función que se llama al terminar cada transmisión
+        (por ejemplo, para inyectar la respuesta del concentrador).
+        @param handler Función a llamar (vacía para ninguna).
+    */
+    void setTransmitHandler(std::function<void(const AirPacket&)> handler);
+
+    const std::vector<AirPacket>& transmitted() const { return _transmitted; }
+    void clearTransmitted() { _transmitted.clear(); }
+
+    /**
+        airtime() calcula el tiempo en el aire de un paquete con la configuración actual.
+        @param size Bytes de payload.
+        @param implicitHeader Si se transmite sin header.
+        @return Tiempo en el aire (en ns).
+    */
+    uint64_t airtime(size_t size, bool implicitHeader) const;
+
+    uint8_t opMode() const { return _regs[0x01] & 0x07; }
+    uint8_t peekRegister(uint8_t address) const { return _regs[address & 0x7f]; }
+    uint8_t peekFifo(uint8_t address) const { return _fifo[address]; }
+
+    /**
+        Contadores:
+            - transactions(), isrTransactions(): transacciones SPI, en total y dentro de un ISR.
+            - bytes(): bytes transferidos por SPI (incluidas las direcciones).
+            - timeInMode(): tiempo total en un modo (en ns), para estimar el consumo.
+    */
+    unsigned long transactions() const { return _transactions; }
+    unsigned long isrTransactions() const { return _isrTransactions; }
+    unsigned long bytes() const { return _bytes; }
+    uint64_t timeInMode(uint8_t mode);
+    void resetCounters();
+
+private:
+    /**
+        OnAir contiene un paquete del canal y si ya comenzó (el próximo evento es su fin).
+    */
+    struct OnAir {
+        AirPacket packet;
+        unsigned long id;
+        bool started;
+    };
+
+    uint8_t readRegister(uint8_t address);
+    void writeRegister(uint8_t address, uint8_t value);
+    void setMode(uint8_t mode);
+    void finishMode();
+    void packetStarted(const OnAir& air);
+    void packetEnded(const OnAir& air);
+    bool listensTo(const AirPacket& packet) const;
+    void setIrqFlags(uint8_t flags);
+    void updateDio();
+    int channelRssi() const;
+    int txPower() const;
+    int rssiOffset() const;
+    uint32_t frequencyRegister() const;
+    uint64_t symbolTime() const;
+    uint8_t nextRandom();
+
+    int _dio0Pin;
+    int _dio1Pin;
+    uint8_t _regs[128];
+    uint8_t _fifo[256];
+    uint8_t _rxByteAddr;
+
+    uint32_t _spiClock;
+    int _address;
+    bool _writing;
+
+    uint64_t _modeDeadline;
+    uint64_t _modeSince;
+    uint64_t _modeStart;
+    uint64_t _modeTime[8];
+    AirPacket _txPacket;
+
+    std::vector<OnAir> _air;
+    unsigned long _nextId;
+    unsigned long _rxLock;
+    bool _activity;
+    int _activityRssi;
+
+    std::vector<AirPacket> _transmitted;
+    std::function<void(const AirPacket&)> _transmitHandler;
+
+    unsigned long _transactions;
+    unsigned long _isrTransactions;
+    unsigned long _bytes;
+    uint32_t _randomState;
+};
+
+#endif